@@ -3,6 +3,7 @@
 #include <fstream>
 #include <vector>
 
+#include "../Models/GameHistory.h"
 #include "../Models/Move.h"
 #include "../Models/Project_path.h"
 
@@ -72,10 +73,19 @@ public:
             print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
             return 1;
         }
+        // Картинки результата тоже загружаются сразу, а не при каждой отрисовке финального экрана
+        white_wins = IMG_LoadTexture(ren, white_path.c_str());
+        black_wins = IMG_LoadTexture(ren, black_path.c_str());
+        draw_result = IMG_LoadTexture(ren, draw_path.c_str());
+        if (!white_wins || !black_wins || !draw_result)
+        {
+            print_exception("IMG_LoadTexture can't load game result pictures from " + textures_path);
+            return 1;
+        }
         SDL_GetRendererOutputSize(ren, &W, &H);
         // Создание начальной расстановки шашек
         make_start_mtx();
-        rerender();
+        present();
         return 0;
     }
 
@@ -83,8 +93,6 @@ public:
     void redraw()
     {
         game_results = -1;
-        history_mtx.clear();
-        history_beat_series.clear();
         make_start_mtx();
         clear_active();
         clear_highlight();
@@ -93,17 +101,7 @@ public:
     // Перемещение шашки с обработкой взятия
     void move_piece(move_pos turn, const int beat_series = 0)
     {
-        // Удаление битой шашки (если есть)
-        if (turn.xb != -1)
-        {
-            mtx[turn.xb][turn.yb] = 0;
-        }
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);
-    }
-
-    // Основная логика перемещения шашки
-    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
-    {
+        const POS_T i = turn.x, j = turn.y, i2 = turn.x2, j2 = turn.y2;
         // Проверка валидности хода
         if (mtx[i2][j2])
         {
@@ -113,19 +111,33 @@ public:
         {
             throw runtime_error("begin position is empty, can't move");
         }
+        MoveUndo undo;
+        // Удаление битой шашки (если есть)
+        if (turn.xb != -1)
+        {
+            undo.beaten = mtx[turn.xb][turn.yb];
+            mtx[turn.xb][turn.yb] = 0;
+        }
         // Превращение в дамку при достижении противоположного края
-        if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))
+        undo.promoted = ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7));
+        if (undo.promoted)
             mtx[i][j] += 2;
         mtx[i2][j2] = mtx[i][j];
         drop_piece(i, j);
-        add_history(beat_series); // сохранение в историю
+        history.push(PackedMove(turn), undo, beat_series); // сохранение в историю
+    }
+
+    // Основная логика перемещения шашки
+    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
+    {
+        move_piece(move_pos(i, j, i2, j2), beat_series);
     }
 
     // Удаление шашки с доски
     void drop_piece(const POS_T i, const POS_T j)
     {
         mtx[i][j] = 0;
-        rerender();
+        invalidate();
     }
 
     // Превращение шашки в дамку
@@ -136,7 +148,7 @@ public:
             throw runtime_error("can't turn into queen in this position");
         }
         mtx[i][j] += 2;
-        rerender();
+        invalidate();
     }
 
     // Получение текущего состояния доски
@@ -153,7 +165,7 @@ public:
             POS_T x = pos.first, y = pos.second;
             is_highlighted_[x][y] = 1;
         }
-        rerender();
+        invalidate();
     }
 
     // Очистка всех подсветок
@@ -163,7 +175,7 @@ public:
         {
             is_highlighted_[i].assign(8, 0);
         }
-        rerender();
+        invalidate();
     }
 
     // Установка выбранной клетки
@@ -171,7 +183,7 @@ public:
     {
         active_x = x;
         active_y = y;
-        rerender();
+        invalidate();
     }
 
     // Сброс выбранной клетки
@@ -179,7 +191,7 @@ public:
     {
         active_x = -1;
         active_y = -1;
-        rerender();
+        invalidate();
     }
 
     // Проверка подсветки клетки
@@ -191,13 +203,11 @@ public:
     // Откат на предыдущее состояние (отмена хода)
     void rollback()
     {
-        auto beat_series = max(1, *(history_beat_series.rbegin()));
-        while (beat_series-- && history_mtx.size() > 1)
+        auto beat_series = max(1, history.last_beat_series());
+        while (beat_series-- && history.size() > 1)
         {
-            history_mtx.pop_back();
-            history_beat_series.pop_back();
+            undo_step(history.pop());
         }
-        mtx = *(history_mtx.rbegin());
         clear_highlight();
         clear_active();
     }
@@ -206,7 +216,7 @@ public:
     void show_final(const int res)
     {
         game_results = res;
-        rerender();
+        invalidate();
     }
 
     // Обновление размеров при изменении окна
@@ -214,6 +224,23 @@ public:
     void reset_window_size()
     {
         SDL_GetRendererOutputSize(ren, &W, &H);
+        invalidate();
+    }
+
+    // Изменения доски только отмечают кадр устаревшим, а рисует его present:
+    // серия изменений (ход, подсветка, выделение) даёт одну отрисовку
+    void invalidate()
+    {
+        dirty = true;
+    }
+
+    // Отрисовка кадра, если он устарел. Рендерер создан с вертикальной синхронизацией,
+    // поэтому кадр выводится не чаще одного раза за обновление экрана
+    void present()
+    {
+        if (!dirty)
+            return;
+        dirty = false;
         rerender();
     }
 
@@ -227,6 +254,9 @@ public:
         SDL_DestroyTexture(b_queen);
         SDL_DestroyTexture(back);
         SDL_DestroyTexture(replay);
+        SDL_DestroyTexture(white_wins);
+        SDL_DestroyTexture(black_wins);
+        SDL_DestroyTexture(draw_result);
         SDL_DestroyRenderer(ren);
         SDL_DestroyWindow(win);
         SDL_Quit();
@@ -239,11 +269,14 @@ public:
     }
 
 private:
-    // Добавление состояния в историю
-    void add_history(const int beat_series = 0)
+    // Отмена шага истории на доске: шашка возвращается, превращение отменяется, битая фигура ставится обратно
+    void undo_step(const GameHistory::Step &step)
     {
-        history_mtx.push_back(mtx);
-        history_beat_series.push_back(beat_series);
+        const move_pos turn = step.turn.to_move_pos();
+        mtx[turn.x][turn.y] = POS_T(mtx[turn.x2][turn.y2] - (step.undo.promoted ? 2 : 0));
+        mtx[turn.x2][turn.y2] = 0;
+        if (step.undo.beaten)
+            mtx[turn.xb][turn.yb] = step.undo.beaten;
     }
     // Создание начальной расстановки
     // function to make start matrix
@@ -260,7 +293,7 @@ private:
                     mtx[i][j] = 1;
             }
         }
-        add_history();
+        history.reset(Position(mtx));
     }
 
     // Полная перерисовка всех элементов
@@ -331,27 +364,19 @@ private:
         // draw result
         if (game_results != -1)
         {
-            string result_path = draw_path;
+            SDL_Texture* result_texture = draw_result;
             if (game_results == 1)
-                result_path = white_path;
+                result_texture = white_wins;
             else if (game_results == 2)
-                result_path = black_path;
-            SDL_Texture* result_texture = IMG_LoadTexture(ren, result_path.c_str());
-            if (result_texture == nullptr)
-            {
-                print_exception("IMG_LoadTexture can't load game result picture from " + result_path);
-                return;
-            }
+                result_texture = black_wins;
             SDL_Rect res_rect{ W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5 };
             SDL_RenderCopy(ren, result_texture, NULL, &res_rect);
-            SDL_DestroyTexture(result_texture);
         }
 
         SDL_RenderPresent(ren);
-        // next rows for mac os
-        SDL_Delay(10);
-        SDL_Event windowEvent;
-        SDL_PollEvent(&windowEvent);
+        // macOS показывает окно, только пока обрабатываются системные события:
+        // они переносятся в очередь SDL, но не выбрасываются, как раньше при SDL_PollEvent
+        SDL_PumpEvents();
     }
 
     // Логирование ошибок
@@ -365,7 +390,7 @@ private:
     int W = 0; // ширина окна
     int H = 0; // высота окна
     // history of boards
-    vector<vector<vector<POS_T>>> history_mtx; // история состояний доски
+    GameHistory history; // история ходов партии: отмена и восстановление любой позиции
 
   private:
     SDL_Window *win = nullptr;
@@ -378,6 +403,11 @@ private:
     SDL_Texture *b_queen = nullptr;
     SDL_Texture *back = nullptr;
     SDL_Texture *replay = nullptr;
+    SDL_Texture *white_wins = nullptr;
+    SDL_Texture *black_wins = nullptr;
+    SDL_Texture *draw_result = nullptr;
+    // Кадр на экране устарел и должен быть перерисован (см. present)
+    bool dirty = true;
     // Пути к файлам текстур
     // texture files names
     const string textures_path = project_path + "Textures/";
@@ -402,7 +432,4 @@ private:
     // matrix of possible moves
     // 1 - white, 2 - black, 3 - white queen, 4 - black queen
     vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
-    // История серий взятий для корректного отката
-    // series of beats for each move
-    vector<int> history_beat_series;
 };
\ No newline at end of file
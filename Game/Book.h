@@ -0,0 +1,146 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "MappedFile.h"
+
+// Книга дебютов, собранная из партий бота с самим собой (Tools/book.cpp).
+// Запись - ход из позиции: ключ позиции, ключ позиции после хода и результаты партий с этим ходом.
+// Записи отсортированы по ключу позиции. Индекс по старшим битам ключа сразу даёт начало
+// нужного участка, поэтому поиск - одно обращение к индексу и короткий просмотр.
+//
+// Файл: заголовок, индекс из (1 << bits) + 1 номеров записей (с выравниванием), записи
+const char BOOK_MAGIC[4] = {'C', 'K', 'B', 'K'};
+
+struct BookEntry
+{
+    uint64_t key;      // позиция вместе с очередью хода
+    uint64_t next_key; // позиция после хода
+    uint32_t games;    // сколько раз ход сыгран
+    uint32_t points;   // очки ходившей стороны: 2 за победу, 1 за ничью
+};
+
+struct BookHeader
+{
+    char magic[4];
+    uint32_t bits;  // число старших битов ключа в индексе
+    uint64_t count; // число записей
+};
+
+class OpeningBook
+{
+  public:
+    // Ключ позиции для книги: ключ Зобриста вместе с очередью хода
+    static uint64_t key(const Position &pos, const bool color)
+    {
+        return pos.key ^ (color ? ZOBRIST.black_turn : 0);
+    }
+
+    // Отображение книги в память, false если файла нет или он повреждён
+    bool load(const std::string &path)
+    {
+        entries = nullptr;
+        count = 0;
+        if (!file.open(path) || file.size() < sizeof(BookHeader))
+            return false;
+        BookHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        const size_t index_size = index_bytes(header.bits);
+        if (!std::equal(BOOK_MAGIC, BOOK_MAGIC + 4, header.magic) || header.bits > 24 ||
+            header.count > file.size() / sizeof(BookEntry) ||
+            file.size() != sizeof(header) + index_size + header.count * sizeof(BookEntry))
+        {
+            file.close();
+            return false;
+        }
+        // Участки индекса должны идти подряд от первой записи до последней, иначе find
+        // вышел бы за пределы файла
+        const uint32_t *now_index = reinterpret_cast<const uint32_t *>(file.data() + sizeof(header));
+        const size_t buckets = size_t(1) << header.bits;
+        bool ok = (now_index[0] == 0 && now_index[buckets] == header.count);
+        for (size_t bucket = 0; ok && bucket < buckets; ++bucket)
+            ok = (now_index[bucket] <= now_index[bucket + 1]);
+        if (!ok)
+        {
+            file.close();
+            return false;
+        }
+        bits = header.bits;
+        count = header.count;
+        index = now_index;
+        entries = reinterpret_cast<const BookEntry *>(file.data() + sizeof(header) + index_size);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    // Ходы из позиции с ключом key: [first, last), пустой промежуток если позиции нет в книге
+    std::pair<const BookEntry *, const BookEntry *> find(const uint64_t key) const
+    {
+        if (empty())
+            return {nullptr, nullptr};
+        const size_t bucket = bucket_of(key, bits);
+        const BookEntry *begin = entries + index[bucket], *end = entries + index[bucket + 1];
+        const BookEntry *first = std::lower_bound(
+            begin, end, key, [](const BookEntry &entry, const uint64_t k) { return entry.key < k; });
+        const BookEntry *last = first;
+        while (last != end && last->key == key)
+            ++last;
+        return {first, last};
+    }
+
+    // Запись книги: записи сортируются, индекс строится по их числу
+    static bool save(const std::string &path, std::vector<BookEntry> book)
+    {
+        std::sort(book.begin(), book.end(), [](const BookEntry &a, const BookEntry &b) {
+            return a.key != b.key ? a.key < b.key : a.next_key < b.next_key;
+        });
+        BookHeader header;
+        std::memcpy(header.magic, BOOK_MAGIC, 4);
+        header.bits = 0;
+        while (header.bits < 20 && (size_t(2) << header.bits) <= book.size())
+            ++header.bits;
+        header.count = book.size();
+        std::vector<uint32_t> book_index(index_bytes(header.bits) / sizeof(uint32_t));
+        size_t pos = 0;
+        for (size_t bucket = 0; bucket <= (size_t(1) << header.bits); ++bucket)
+        {
+            while (pos < book.size() && bucket_of(book[pos].key, header.bits) < bucket)
+                ++pos;
+            book_index[bucket] = uint32_t(pos);
+        }
+        std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+        fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        fout.write(reinterpret_cast<const char *>(book_index.data()),
+                   std::streamsize(book_index.size() * sizeof(uint32_t)));
+        fout.write(reinterpret_cast<const char *>(book.data()), std::streamsize(book.size() * sizeof(BookEntry)));
+        return bool(fout);
+    }
+
+  private:
+    // Размер индекса, выровненный до 8 байт, чтобы записи лежали по выровненным адресам
+    static size_t index_bytes(const uint32_t bits)
+    {
+        return (((size_t(1) << bits) + 1) * sizeof(uint32_t) + 7) / 8 * 8;
+    }
+
+    // Номер участка индекса: старшие bits битов ключа
+    static size_t bucket_of(const uint64_t key, const uint32_t bits)
+    {
+        return bits ? size_t(key >> (64 - bits)) : 0;
+    }
+
+    MappedFile file;
+    const uint32_t *index = nullptr;
+    const BookEntry *entries = nullptr;
+    uint32_t bits = 0;
+    size_t count = 0;
+};
@@ -1,7 +1,10 @@
 #pragma once
 #include <fstream>
+#include <string>
+#include <vector>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
+using namespace std;
 
 #include "../Models/Project_path.h"
 
@@ -9,16 +12,31 @@ using json = nlohmann::json;
 class Config
 {
   public:
-    Config()
+    Config() : path(project_path + "settings.json")
     {
         reload();
     }
-    // Загружает настройки из "settings.json"
+    // Настройки из другого файла того же формата (например, для матча двух ботов)
+    explicit Config(const string &path) : path(path)
+    {
+        reload();
+    }
+    // Загружает настройки из файла (по умолчанию "settings.json")
     void reload()
     {
-        std::ifstream fin(project_path + "settings.json");
+        std::ifstream fin(path);
         fin >> config; // сохраняет в config
         fin.close();
+        // В файлах старых версий нет части настроек бота: недостающие берутся по умолчанию,
+        // поэтому чтение любой настройки из defaults() безопасно
+        for (const auto &dir : defaults().items())
+        {
+            for (const auto &setting : dir.value().items())
+            {
+                if (!has(dir.key(), setting.key()))
+                    config[dir.key()][setting.key()] = setting.value();
+            }
+        }
     }
 
     // Перегруженный оператор круглые скобки () обеспечивает удобный доступ
@@ -28,6 +46,76 @@ class Config
         return config[setting_dir][setting_name];
     }
 
+    // Есть ли такая настройка в файле
+    bool has(const string &setting_dir, const string &setting_name) const
+    {
+        return config.contains(setting_dir) && config[setting_dir].contains(setting_name);
+    }
+
+    // Сверка файла с defaults(): настройки без значения по умолчанию, значения по умолчанию без
+    // настройки в файле и разные типы значений (проверяется в Tools/bench.cpp --check).
+    // Разные значения одного типа ошибкой не считаются: их меняет пользователь, они попадают в notes
+    vector<string> check_defaults(vector<string> &notes) const
+    {
+        json file;
+        std::ifstream fin(path);
+        fin >> file;
+        vector<string> res;
+        for (const auto &dir : defaults().items())
+        {
+            const json settings = file.contains(dir.key()) ? file[dir.key()] : json::object();
+            for (const auto &setting : settings.items())
+            {
+                if (!dir.value().contains(setting.key()))
+                    res.push_back(dir.key() + "." + setting.key() + " has no default");
+            }
+            for (const auto &def : dir.value().items())
+            {
+                const string name = dir.key() + "." + def.key();
+                if (!settings.contains(def.key()))
+                    res.push_back(name + " is missing in " + path);
+                else if (settings[def.key()].is_number() != def.value().is_number() ||
+                         settings[def.key()].is_boolean() != def.value().is_boolean() ||
+                         settings[def.key()].is_string() != def.value().is_string())
+                    res.push_back(name + " has another type than its default");
+                else if (settings[def.key()] != def.value())
+                    notes.push_back(name + " = " + settings[def.key()].dump() + ", default " + def.value().dump());
+            }
+        }
+        return res;
+    }
+
+    // Изменение настройки в памяти (файл не перезаписывается)
+    template <class T> void set(const string &setting_dir, const string &setting_name, const T &value)
+    {
+        config[setting_dir][setting_name] = value;
+    }
+
   private:
+    // Значения по умолчанию. Это копия раздела "Bot" из "settings.json": новая настройка или новое
+    // значение по умолчанию вносятся в оба места, расхождения находит bench --check
+    static const json &defaults()
+    {
+        static const json res = {{"Bot",
+                                   {{"IsWhiteBot", false},
+                                    {"IsBlackBot", true},
+                                    {"WhiteBotLevel", 0},
+                                    {"BlackBotLevel", 5},
+                                    {"BotScoringType", "NumberAndPotential"},
+                                    {"BotDelayMS", 0},
+                                    {"BotThinkMS", 0},
+                                    {"NoRandom", false},
+                                    {"Optimization", "O1"},
+                                    {"QuiescenceDepth", 8},
+                                    {"HashSizeMB", 16},
+                                    {"BotThreads", 1},
+                                    {"ParallelSearch", "LazySMP"},
+                                    {"TablebasePath", "Tablebases/"},
+                                    {"BookPath", "book.bin"},
+                                    {"Ponder", true}}}};
+        return res;
+    }
+
+    string path; // файл настроек
     json config;
 };
\ No newline at end of file
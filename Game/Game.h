@@ -1,5 +1,7 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <future>
 #include <thread>
 
 #include "../Models/Project_path.h"
@@ -11,7 +13,7 @@
 class Game
 {
   public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&config)
     {
         ofstream fout(project_path + "log.txt", ios_base::trunc);
         fout.close();
@@ -24,7 +26,7 @@ class Game
         // Если повтор игры, то перезагружается состояние
         if (is_replay)
         {
-            logic = Logic(&board, &config);
+            logic = Logic(&config);
             config.reload();
             board.redraw();
         }
@@ -42,7 +44,7 @@ class Game
         {
             beat_series = 0;
             // Поиск возможных ходов для текущего игрока
-            logic.find_turns(turn_num % 2);
+            logic.find_turns(turn_num % 2, board.get_board());
             // Если ходов нет - конец игры
             if (logic.turns.empty())
                 break;
@@ -50,8 +52,15 @@ class Game
             // Выбор того, кто ходит (бот или не бот)
             if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot")))
             {
+                // Пока игрок думает, бот заранее ищет ответы на его ходы
+                const string opponent = ((1 - turn_num % 2) ? "Black" : "White");
+                if (config("Bot", "Ponder") && config("Bot", "Is" + opponent + "Bot"))
+                {
+                    logic.start_pondering(board.get_board(), turn_num % 2, config("Bot", opponent + "BotLevel"));
+                }
                 // Если ходит игрок, то вызывается функция хода игрока
                 auto resp = player_turn(turn_num % 2); // Получение ответа от действия игрока
+                logic.stop_pondering();
                 // Если игрок нажал выход - игра заканчивается
                 if (resp == Response::QUIT)
                 {
@@ -68,7 +77,7 @@ class Game
                 else if (resp == Response::BACK)
                 {
                     if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")) &&
-                        !beat_series && board.history_mtx.size() > 2)
+                        !beat_series && board.history.size() > 2)
                     {
                         board.rollback();
                         --turn_num; // отмена хода бота
@@ -81,9 +90,28 @@ class Game
                     beat_series = 0;
                 }
             }
-            // Ход бота
+            // Ход бота: пока он думает, окно отвечает на выход, переигровку и откат
             else
-                bot_turn(turn_num % 2);
+            {
+                auto resp = bot_turn(turn_num % 2);
+                if (resp == Response::QUIT)
+                {
+                    is_quit = true;
+                    break;
+                }
+                else if (resp == Response::REPLAY)
+                {
+                    is_replay = true;
+                    break;
+                }
+                // Откат последнего хода перед ходом бота, после него ходит тот же игрок
+                else if (resp == Response::BACK)
+                {
+                    board.rollback();
+                    turn_num -= 2;
+                    beat_series = 0;
+                }
+            }
         }
         auto end = chrono::steady_clock::now(); // конец таймера
         ofstream fout(project_path + "log.txt", ios_base::app);
@@ -117,41 +145,77 @@ class Game
     }
 
   private:
-    void bot_turn(const bool color)
+    // Ход бота. Поиск идёт в отдельном потоке, а окно тем временем обрабатывает события:
+    // выход, переигровка или откат отменяют поиск и возвращаются как ответ (OK - бот сходил)
+    Response bot_turn(const bool color)
     {
         auto start = chrono::steady_clock::now(); // начало таймера
 
         // Получение задержки между ходами из конфигурации
-        auto delay_ms = config("Bot", "BotDelayMS");
-        // Создание отдельного потока для равной задержки на каждый ход
-        // Параллельное выполнение задержки и вычислений
-        // new thread for equal delay for each turn
-        thread th(SDL_Delay, delay_ms);
-        // Поиск лучших ходов с использованием алгоритма бота
-        auto turns = logic.find_best_turns(color);
-        // Ожидание завершения потока задержки
-        th.join();
+        // Задержка идёт одновременно с поиском: ход делается не раньше, чем через delay_ms
+        const int delay_ms = config("Bot", "BotDelayMS");
+        // Поиск лучших ходов с использованием алгоритма бота,
+        // если ответ не был найден заранее, пока думал игрок
+        vector<move_pos> turns;
+        const bool pondered = logic.take_pondered_turns(board.get_board(), color, turns);
+        future<vector<move_pos>> search;
+        atomic<bool> cancel(false);
+        if (!pondered)
+        {
+            logic.set_cancel(&cancel);
+            search = async(launch::async, [this, color, mtx = board.get_board()]() {
+                auto res = logic.find_best_turns(mtx, color);
+                Hand::notify_search_done();
+                return res;
+            });
+        }
+        auto resp = hand.wait_bot(
+            [&]() { return pondered || search.wait_for(chrono::seconds(0)) == future_status::ready; },
+            start + chrono::milliseconds(delay_ms));
+        if (!pondered)
+        {
+            // Поиск проверяет флаг раз в 1024 узла, поэтому отменённый поиск заканчивается за доли миллисекунды
+            if (resp != Response::OK)
+                cancel = true;
+            auto res = search.get();
+            logic.set_cancel(nullptr);
+            if (resp != Response::OK)
+                return resp;
+            turns = res;
+        }
         bool is_first = true;
         // Выполнение найденной последовательности ходов
         // making moves
         for (auto turn : turns)
         {
             // Задержка между подходами в серии ходов
+            // Откат посреди серии не выполняется: ход бота доигрывается
             if (!is_first)
             {
-                SDL_Delay(delay_ms);
+                const auto until = chrono::steady_clock::now() + chrono::milliseconds(delay_ms);
+                do
+                    resp = hand.wait_bot([]() { return true; }, until);
+                while (resp == Response::BACK);
+                if (resp != Response::OK)
+                    return resp;
             }
             is_first = false;
             // Обновление счетчика серии взятий
             beat_series += (turn.xb != -1);
             // Выполнение одного хода на доске
             board.move_piece(turn, beat_series);
+            board.present();
         }
 
         auto end = chrono::steady_clock::now(); // конец таймера
         ofstream fout(project_path + "log.txt", ios_base::app);
         fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+        // Счётчики поиска одной строкой JSON: узлы, отсечения, попадания в таблицу
+        json search_json = logic.search_stats().to_json();
+        search_json["color"] = (color ? "black" : "white");
+        fout << search_json.dump() << "\n";
         fout.close();
+        return Response::OK;
     }
 
     Response player_turn(const bool color)
@@ -239,7 +303,7 @@ class Game
         while (true)
         {
             // Поиск возможных продолжений битья
-            logic.find_turns(pos.x2, pos.y2);
+            logic.find_turns(pos.x2, pos.y2, board.get_board());
             // Если нет возможности бить - конец хода
             if (!logic.have_beats)
                 break;
@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+#include <functional>
 #include <tuple>
 
 #include "../Models/Move.h"
@@ -14,107 +16,123 @@ class Hand
     {
     }
     // Ожидание и обработка действие пользователя
+    // Поток спит в SDL_WaitEvent, пока очередь событий пуста, и не занимает ядро (оно нужно фоновому поиску)
     tuple<Response, POS_T, POS_T> get_cell() const
     {
-        SDL_Event windowEvent; // Структура для хранения события SDL
-        Response resp = Response::OK; // ответ
-        int x = -1, y = -1; // координаты мыши на экране
         int xc = -1, yc = -1; // координаты клетки на доске
-        // Бесконечный цикл ожидания события
-        while (true)
-        {
-            // Проверка наличия события в очереди SDL
-            if (SDL_PollEvent(&windowEvent))
-            {
-                switch (windowEvent.type)
-                {
-                // Событие закрытия окна
-                case SDL_QUIT:
-                    resp = Response::QUIT;
-                    break;
-                // Нажатие кнопки мыши
-                case SDL_MOUSEBUTTONDOWN:
-                    // Получение координат мыши
-                    x = windowEvent.motion.x;
-                    y = windowEvent.motion.y;
-                    // Преобразование координат экрана в координаты клеток доски
-                    xc = int(y / (board->H / 10) - 1);
-                    yc = int(x / (board->W / 10) - 1);
-                    // Проверка нажатия на кнопку "Назад"
-                    if (xc == -1 && yc == -1 && board->history_mtx.size() > 1)
-                    {
-                        resp = Response::BACK;
-                    }
-                    // Проверка нажатия на кнопку "Повторить"
-                    else if (xc == -1 && yc == 8)
-                    {
-                        resp = Response::REPLAY;
-                    }
-                    // Проверка нажатия на игровое поле
-                    else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
-                    {
-                        resp = Response::CELL;
-                    }
-                    // Нажатие вне игрового поля и кнопок - игнорирование
-                    else
-                    {
-                        xc = -1;
-                        yc = -1;
-                    }
-                    break;
-                // События окна
-                case SDL_WINDOWEVENT:
-                    // Обработка изменения размера окна
-                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
-                    {
-                        board->reset_window_size();
-                        break;
-                    }
-                }
-                // Если получен значимый ответ - выход из цикла
-                if (resp != Response::OK)
-                    break;
-            }
-        }
+        const Response resp = wait_response(false, xc, yc);
         // Возврат результат: тип действия + координаты клетки
         return {resp, xc, yc};
     }
     // Ожидание действия пользователя на финальном экране
     Response wait() const
+    {
+        int xc = -1, yc = -1;
+        return wait_response(true, xc, yc);
+    }
+
+    // Ожидание хода бота: окно продолжает обрабатывать события, пока ход не готов (ready)
+    // и не прошла задержка до until. Поток поиска будит окно событием SEARCH_DONE.
+    // OK - можно делать ход, QUIT, REPLAY и BACK - пользователь прервал ожидание (нажатия на доску не учитываются)
+    Response wait_bot(const function<bool()> &ready, const chrono::steady_clock::time_point until) const
     {
         SDL_Event windowEvent;
-        Response resp = Response::OK;
+        int xc = -1, yc = -1;
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
+            board->present();
+            const auto now = chrono::steady_clock::now();
+            if (ready() && now >= until)
+                return Response::OK;
+            // Пока идёт задержка - ожидание с таймаутом, потом до события
+            if (now < until)
             {
-                switch (windowEvent.type)
-                {
-                case SDL_QUIT:
-                    resp = Response::QUIT;
-                    break;
-                case SDL_WINDOWEVENT_SIZE_CHANGED:
-                    board->reset_window_size();
-                    break;
-                case SDL_MOUSEBUTTONDOWN: {
-                    // Определение координат нажатия
-                    int x = windowEvent.motion.x;
-                    int y = windowEvent.motion.y;
-                    int xc = int(y / (board->H / 10) - 1);
-                    int yc = int(x / (board->W / 10) - 1);
-                    // Проверка нажатия на кнопку "Повторить"
-                    if (xc == -1 && yc == 8)
-                        resp = Response::REPLAY;
-                }
-                break;
-                }
-                if (resp != Response::OK)
-                    break;
+                const auto left = chrono::duration_cast<chrono::milliseconds>(until - now).count() + 1;
+                if (!SDL_WaitEventTimeout(&windowEvent, int(left)))
+                    continue;
             }
+            // Ошибка ожидания означает, что события больше не придут - игра закрывается
+            else if (!SDL_WaitEvent(&windowEvent))
+                return Response::QUIT;
+            const Response resp = dispatch(windowEvent, false, xc, yc);
+            if (resp != Response::OK && resp != Response::CELL)
+                return resp;
+        }
+    }
+
+    // Событие, которым поток поиска сообщает, что ход бота найден (его можно отправлять из любого потока)
+    static void notify_search_done()
+    {
+        SDL_Event done{};
+        done.type = SEARCH_DONE;
+        SDL_PushEvent(&done);
+    }
+
+  private:
+    static const Uint32 SEARCH_DONE = SDL_USEREVENT;
+
+    // Ожидание событий до первого значимого ответа
+    // final_screen - финальный экран: из кнопок работает только "Повторить"
+    Response wait_response(const bool final_screen, int &xc, int &yc) const
+    {
+        SDL_Event windowEvent; // Структура для хранения события SDL
+        Response resp = Response::OK;
+        while (resp == Response::OK)
+        {
+            // Изменения доски выводятся перед сном, одним кадром
+            board->present();
+            // Ошибка ожидания означает, что события больше не придут - игра закрывается
+            if (!SDL_WaitEvent(&windowEvent))
+                return Response::QUIT;
+            resp = dispatch(windowEvent, final_screen, xc, yc);
         }
         return resp;
     }
 
+    // Обработка одного события: ответ (OK - событие не требует ответа) и клетка нажатия
+    Response dispatch(const SDL_Event &windowEvent, const bool final_screen, int &xc, int &yc) const
+    {
+        switch (windowEvent.type)
+        {
+        // Событие закрытия окна
+        case SDL_QUIT:
+            return Response::QUIT;
+        // События окна
+        case SDL_WINDOWEVENT:
+            // Обработка изменения размера окна
+            if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                board->reset_window_size();
+            // Окно снова видно: содержимое экрана могло пропасть
+            else if (windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED)
+                board->invalidate();
+            return Response::OK;
+        // Нажатие кнопки мыши
+        case SDL_MOUSEBUTTONDOWN: {
+            // Преобразование координат экрана в координаты клеток доски
+            xc = int(windowEvent.button.y / (board->H / 10) - 1);
+            yc = int(windowEvent.button.x / (board->W / 10) - 1);
+            // Проверка нажатия на кнопку "Повторить"
+            if (xc == -1 && yc == 8)
+                return Response::REPLAY;
+            if (!final_screen)
+            {
+                // Проверка нажатия на кнопку "Назад"
+                if (xc == -1 && yc == -1 && board->history.size() > 1)
+                    return Response::BACK;
+                // Проверка нажатия на игровое поле
+                if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
+                    return Response::CELL;
+            }
+            // Нажатие вне игрового поля и кнопок - игнорирование
+            xc = -1;
+            yc = -1;
+            return Response::OK;
+        }
+        default:
+            return Response::OK;
+        }
+    }
+
   private:
     Board *board;
 };
@@ -1,83 +1,499 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "../Models/Move.h"
-#include "Board.h"
+#include "../Models/MoveList.h"
+#include "../Models/Position.h"
+#include "Book.h"
 #include "Config.h"
+#include "Ponder.h"
+#include "SearchPolicy.h"
+#include "SearchStats.h"
+#include "SplitSearch.h"
+#include "Tablebase.h"
+#include "TransTable.h"
 
 const int INF = 1e9;
+const int MIN_SPLIT_DEPTH = 2;   // узлы ближе к листьям не делятся между потоками
+const double ASPIRATION = 1.05;   // окно итерации углубления: оценка прошлой итерации, делённая и умноженная на него
+
+// Результат учёта оценки хода
+enum class Cut
+{
+    NONE,  // отсечения нет
+    BETA,  // альфа-бета отсечение
+    EQUAL  // отсечение на равенстве оценок (O2)
+};
 
 class Logic
 {
   public:
-      // Инициализация объектов доски и конфигурации
-    Logic(Board *board, Config *config) : board(board), config(config)
+    // Инициализация конфигурации
+    // Логика не зависит от отрисовки: доска передаётся в виде матрицы или упакованной позиции
+    Logic(Config *config) : config(config)
     {
         // Инициализация генератора случайных чисел
+        no_random = (*config)("Bot", "NoRandom");
         rand_eng = std::default_random_engine (
-            !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
-        scoring_mode = (*config)("Bot", "BotScoringType");
-        optimization = (*config)("Bot", "Optimization");
+            !no_random ? unsigned(time(0)) : 0);
+        // Оценка и отсечения выбираются один раз, дальше поиск идёт в скомпилированном под них варианте
+        choose_policies((*config)("Bot", "BotScoringType"), (*config)("Bot", "Optimization"));
+        quiescence_depth = (*config)("Bot", "QuiescenceDepth");
+        // Таблица транспозиций создаётся один раз на партию и общая для всех потоков поиска
+        tt = make_shared<TransTable>();
+        tt->resize((*config)("Bot", "HashSizeMB"));
+        // Базы эндшпиля отображаются в память, отсутствующие файлы просто не используются
+        tablebase = make_shared<Tablebase>();
+        const string tablebase_path = (*config)("Bot", "TablebasePath");
+        tablebase->load(project_path + tablebase_path);
+        // Книга дебютов тоже отображается в память, без файла бот просто ищет ход
+        book = make_shared<OpeningBook>();
+        const string book_path = (*config)("Bot", "BookPath");
+        if (!book_path.empty())
+            book->load(project_path + book_path);
     }
 
     // Основной метод поиска лучших ходов для бота
-    vector<move_pos> find_best_turns(const bool color)
+    vector<move_pos> find_best_turns(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        // Доска переводится в упакованное представление один раз, в корне поиска
+        return find_best_turns(Position(mtx), color);
+    }
+
+    // Поиск лучших ходов из упакованной позиции
+    // Если задано время на ход (BotThinkMS), глубина увеличивается, пока не кончится время,
+    // иначе поиск идёт на глубину Max_depth
+    vector<move_pos> find_best_turns(const Position &pos, const bool color)
+    {
+        const auto start = chrono::steady_clock::now();
+        // Уровень бота из настроек не проверяется: ходы-убийцы и счётчики отсечений рассчитаны
+        // не больше чем на MAX_SEARCH_DEPTH уровней (помощники Lazy SMP идут на один глубже)
+        Max_depth = min(max(Max_depth, 0), MAX_SEARCH_DEPTH - 1);
+        stats = SearchStats();
+        // Прошлый поиск мог быть отменён
+        stop_search = false;
+        vector<Logic> helpers;
+        // Позиция есть в базах эндшпиля - ход берётся из базы без поиска
+        vector<move_pos> tablebase_res;
+        if (find_tablebase_turns(pos, color, tablebase_res))
+        {
+            stats.source = "tablebase";
+            stats.score = root_score;
+            finish_stats(helpers, start);
+            return tablebase_res;
+        }
+        // Позиция есть в книге дебютов - ход из книги без поиска
+        vector<move_pos> book_res;
+        if (find_book_turns(pos, color, book_res))
+        {
+            stats.source = "book";
+            finish_stats(helpers, start);
+            return book_res;
+        }
+
+        tt->new_search();
+        new_ordering();
+        const int think_ms = (*config)("Bot", "BotThinkMS");
+
+        // Поиск на фиксированную глубину берёт из таблицы только записи той же глубины:
+        // тогда результат не зависит ни от истории таблицы, ни от числа потоков
+        tt_exact_depth = (think_ms <= 0);
+        stats.depth = Max_depth;
+
+        const int threads = (*config)("Bot", "BotThreads");
+        const string parallel_search = (*config)("Bot", "ParallelSearch");
+        vector<thread> workers;
+        helpers.reserve(max(threads - 1, 0));
+        // YBW: дерево поиска делится между потоками, результат совпадает с однопоточным
+        if (threads > 1 && parallel_search == "YBW")
+        {
+            WorkStealing ybw_pool(threads);
+            pool = &ybw_pool;
+            shared_stop = &ybw_pool.stop;
+            for (int i = 1; i < threads; ++i)
+            {
+                helpers.push_back(*this);
+                helpers.back().worker_id = i;
+                workers.emplace_back(&Logic::split_worker, &helpers.back());
+            }
+            auto res = (think_ms > 0 ? find_best_turns_in_time(pos, color, think_ms) : find_best_turns_depth(pos, color));
+            stats.score = root_score;
+            ybw_pool.quit = true;
+            for (auto &worker : workers)
+                worker.join();
+            pool = nullptr;
+            shared_stop = nullptr;
+            finish_stats(helpers, start);
+            return res;
+        }
+
+        // Lazy SMP: помощники ищут ту же позицию в своём порядке ходов и наполняют общую таблицу,
+        // ход выбирает основной поток
+        const int limit = (think_ms > 0 ? MAX_SEARCH_DEPTH : Max_depth + 1);
+        atomic<bool> helpers_stop(false);
+        for (int i = 1; i < threads; ++i)
+        {
+            helpers.push_back(*this);
+            helpers.back().rand_eng.seed(unsigned(rand_eng()) + i);
+            helpers.back().shared_stop = &helpers_stop;
+            workers.emplace_back(&Logic::helper_search, &helpers.back(), pos, color, limit, i % 2);
+        }
+
+        auto res = (think_ms > 0 ? find_best_turns_in_time(pos, color, think_ms) : find_best_turns_depth(pos, color));
+        stats.score = root_score;
+
+        helpers_stop = true;
+        for (auto &worker : workers)
+            worker.join();
+        finish_stats(helpers, start);
+        return res;
+    }
+
+    // Флаг отмены для следующих поисков: поиск, запущенный в другом потоке, прекращается вскоре
+    // после его установки, результат отменённого поиска не используется (nullptr - без отмены)
+    void set_cancel(const atomic<bool> *flag)
+    {
+        cancel = flag;
+    }
+
+    // Счётчики последнего поиска (find_best_turns или ход, найденный заранее)
+    const SearchStats &search_stats() const
+    {
+        return stats;
+    }
+
+    // Оценка позиции с точки зрения бота цвета bot_color (для замеров и инструментов)
+    double evaluate(const Position &pos, const bool bot_color) const
+    {
+        return (this->*score_fn)(pos, bot_color);
+    }
+
+    // Обдумывание на времени соперника: пока человек цвета color думает над ходом,
+    // в фоне ищутся ответы бота (глубина level) на все его ходы, начиная с самых сильных
+    void start_pondering(const vector<vector<POS_T>> &mtx, const bool color, const int level)
+    {
+        stop_pondering();
+        ponder = make_shared<Ponder>();
+        // Поиск идёт в копии логики: таблица транспозиций общая, поэтому она прогревается и для бота
+        Logic thinker(*this);
+        thinker.ponder = nullptr;
+        thinker.cancel = &ponder->stop;
+        thinker.Max_depth = level;
+        ponder->worker = thread([thinker, pos = Position(mtx), color, state = ponder.get()]() mutable {
+            thinker.ponder_search(pos, color, *state);
+        });
+    }
+
+    // Человек сходил: фоновый поиск останавливается, готовые ответы остаются
+    void stop_pondering()
+    {
+        if (!ponder)
+            return;
+        ponder->stop = true;
+        if (ponder->worker.joinable())
+            ponder->worker.join();
+    }
+
+    // Ответ бота цвета color, найденный заранее, false если эту позицию не успели просчитать
+    bool take_pondered_turns(const vector<vector<POS_T>> &mtx, const bool color, vector<move_pos> &res)
+    {
+        if (!ponder)
+            return false;
+        stop_pondering();
+        const Position pos(mtx);
+        const auto it = ponder->results.find(ponder_key(pos, color));
+        const bool found = (it != ponder->results.end());
+        if (found)
+        {
+            res = it->second;
+            stats = SearchStats();
+            stats.source = "ponder";
+        }
+        ponder.reset();
+        return found;
+    }
+
+private:
+    // Фоновый поиск ответов на все ходы человека цвета color
+    void ponder_search(const Position &pos, const bool color, Ponder &state)
+    {
+        // Первыми просчитываются ходы, после которых позиция хуже всего для бота
+        auto replies = find_full_turns(pos, color);
+        stable_sort(replies.begin(), replies.end(), [&](const auto &a, const auto &b) {
+            return evaluate(a.second, !color) < evaluate(b.second, !color);
+        });
+        for (const auto &reply : replies)
+        {
+            auto res = find_best_turns(reply.second, !color);
+            if (state.stop)
+                break;
+            lock_guard<mutex> guard(state.lock);
+            state.results[ponder_key(reply.second, !color)] = res;
+        }
+    }
+
+    // Ключ позиции для готовых ответов: позиция и очередь хода
+    static uint64_t ponder_key(const Position &pos, const bool color)
+    {
+        return pos.key ^ (color ? ZOBRIST.black_turn : 0);
+    }
+
+    // Ход по базе эндшпиля: при выигрыше - самый быстрый, при проигрыше - самый долгий
+    // Ничейные позиции база не разыгрывает: ход выбирает поиск, а проигрышные продолжения он видит по базе
+    bool find_tablebase_turns(const Position &pos, const bool color, vector<move_pos> &res)
+    {
+        uint8_t value;
+        if (!tablebase->probe(pos, color, value) || value == TB_DRAW)
+            return false;
+        auto full_turns = find_full_turns(pos, color);
+        if (full_turns.empty())
+            return false;
+        shuffle(full_turns.begin(), full_turns.end(), rand_eng);
+        int best_rank = -1;
+        vector<move_pos> best;
+        for (const auto &full_turn : full_turns)
+        {
+            uint8_t next_value;
+            // Позиции после хода нет в загруженных базах (например, нет файла материала после
+            // превращения) - ходы нельзя сравнить, ход выбирает обычный поиск
+            if (!tablebase->probe(full_turn.second, !color, next_value))
+                return false;
+            // При выигрыше лучше тот ход, после которого соперник проиграет быстрее всего
+            const int rank = (value % 2 ? (next_value % 2 ? 0 : TB_DRAW - next_value) : next_value);
+            if (rank > best_rank)
+            {
+                best_rank = rank;
+                best = full_turn.first;
+            }
+        }
+        res = best;
+        root_score = (value % 2 ? INF : 0);
+        return true;
+    }
+
+    // Ход из книги дебютов: ходы с лучшими результатами выбираются чаще,
+    // без рандома (NoRandom) - всегда ход с наибольшим весом
+    bool find_book_turns(const Position &pos, const bool color, vector<move_pos> &res)
+    {
+        const auto book_turns = book->find(OpeningBook::key(pos, color));
+        if (book_turns.first == book_turns.second)
+            return false;
+        vector<pair<vector<move_pos>, uint32_t>> weighted;
+        uint64_t total = 0;
+        for (const auto &full_turn : find_full_turns(pos, color))
+        {
+            const uint64_t next_key = OpeningBook::key(full_turn.second, !color);
+            for (const BookEntry *entry = book_turns.first; entry != book_turns.second; ++entry)
+            {
+                // Ходы, которые ни разу не принесли очков, не играются
+                if (entry->next_key == next_key && entry->points > 0)
+                {
+                    weighted.emplace_back(full_turn.first, entry->points);
+                    total += entry->points;
+                }
+            }
+        }
+        if (weighted.empty())
+            return false;
+        if (no_random)
+        {
+            res = max_element(weighted.begin(), weighted.end(), [](const auto &a, const auto &b) {
+                      return a.second < b.second;
+                  })->first;
+        }
+        else
+        {
+            uint64_t choice = uniform_int_distribution<uint64_t>(0, total - 1)(rand_eng);
+            for (const auto &turn : weighted)
+            {
+                if (choice < turn.second)
+                {
+                    res = turn.first;
+                    break;
+                }
+                choice -= turn.second;
+            }
+        }
+        return true;
+    }
+
+    // Итеративное углубление: результат последней завершённой итерации
+    vector<move_pos> find_best_turns_in_time(const Position &pos, const bool color, const int think_ms)
+    {
+        deadline = chrono::steady_clock::now() + chrono::milliseconds(think_ms);
+        const int level = Max_depth;
+        vector<move_pos> res;
+        double score = 0;
+        for (Max_depth = 0; Max_depth < MAX_SEARCH_DEPTH; ++Max_depth)
+        {
+            // Нулевая итерация всегда доводится до конца, чтобы у бота был ход
+            check_time = (Max_depth > 0);
+            auto now_res = find_best_turns_window(pos, color, Max_depth > 0);
+            if (stop_search)
+                break;
+            res = now_res;
+            score = root_score;
+            stats.depth = Max_depth;
+            // Лучший ход итерации проверяется первым на следующей итерации
+            root_turn = res.empty() ? PackedMove() : PackedMove(res[0]);
+            // Найден выигрыш или проигрыш - глубже искать незачем
+            if (res.empty() || root_score >= INF || root_score <= 0 || chrono::steady_clock::now() >= deadline)
+                break;
+        }
+        check_time = false;
+        stop_search = false;
+        root_turn = PackedMove();
+        // Оценка прерванной итерации неточна, остаётся оценка последней завершённой
+        root_score = score;
+        Max_depth = level;
+        return res;
+    }
+
+    // Итерация углубления с окном вокруг оценки прошлой итерации (aspiration window).
+    // Узкое окно отсекает больше, но если оценка вышла за него, итерация повторяется
+    // с окном, открытым с этой стороны
+    vector<move_pos> find_best_turns_window(const Position &pos, const bool color, const bool use_window)
+    {
+        // Выигрыш и проигрыш не ищутся в окне: их оценки не отношение сил
+        if (!aspiration || !use_window || root_score <= 0 || root_score >= INF)
+            return find_best_turns_depth(pos, color);
+        double alpha = root_score / ASPIRATION, beta = root_score * ASPIRATION;
+        while (true)
+        {
+            auto res = find_best_turns_depth(pos, color, alpha, beta);
+            if (stop_search)
+                return res;
+            if (root_score < alpha)
+                alpha = -1;
+            else if (root_score > beta)
+                beta = INF + 1;
+            else
+                return res;
+            ++stats.aspiration_fails;
+        }
+    }
+
+    // Поток-помощник Lazy SMP: углубляется сам, начиная со сдвига offset (половина помощников
+    // идёт на глубину впереди основного потока), пока основной поток не закончит поиск
+    void helper_search(const Position pos, const bool color, const int limit, const int offset)
+    {
+        for (Max_depth = offset; Max_depth <= limit && !stop_search; ++Max_depth)
+        {
+            find_best_turns_depth(pos, color);
+        }
+    }
+
+    // Поиск на фиксированную глубину Max_depth
+    // alpha, beta - окно оценки корня: если оценка вышла за окно, она лишь граница
+    vector<move_pos> find_best_turns_depth(const Position &pos, const bool color, const double alpha = -1,
+                                           const double beta = INF + 1)
     {
         // Очистка предыдущих результатов поиска
         next_move.clear();
         next_best_state.clear();
-        // Построение дерева решений: запуск рекурсивного поиска
-        find_first_best_turn(board->get_board(), color, -1, -1, 0);
+        // Построение дерева решений: запуск рекурсивного поиска на изменяемой копии позиции
+        Position root = pos;
+        root_score = (this->*root_search_fn)(root, color, -1, 0, alpha, beta);
         // Восстановление последовательности ходов из дерева решений
         vector<move_pos> res;
         int state = 0;
         // Восстановление путьи лучших ходов по сохранённым состояниям
-        while (state != -1 && next_move[state].x != -1) {
-            res.push_back(next_move[state]); // добавление хода в результат
+        while (state != -1 && !next_move[state].empty()) {
+            res.push_back(next_move[state].to_move_pos()); // добавление хода в результат
             state = next_best_state[state]; // переход к следующему состоянию
         }
         // Возврат последовательности лучших ходов
         return res;
     }
 
-private:
-    // Симуляция хода на копии матрицы состояния
-    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const
+    // Проверка, не пора ли прервать поиск: вышло время на ход или основной поток уже закончил
+    // (часы и флаг опрашиваются раз в 1024 узла)
+    bool time_is_up()
     {
-        // Удаление битой шашки
-        if (turn.xb != -1)
-            mtx[turn.xb][turn.yb] = 0;
-        // Превращение в дамку при достижении края
-        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7))
-            mtx[turn.x][turn.y] += 2;
-        // Перемещение шашки
-        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];
-        mtx[turn.x][turn.y] = 0;
-        return mtx;
+        if (!(++time_counter & 1023))
+        {
+            if (check_time && chrono::steady_clock::now() >= deadline)
+            {
+                stop_search = true;
+                // Потоки YBW тоже должны бросить свои задачи
+                if (pool)
+                    pool->stop = true;
+            }
+            if (shared_stop && shared_stop->load(memory_order_relaxed))
+                stop_search = true;
+            // Поиск отменён извне: ход человека при обдумывании, выход или откат в окне
+            if (cancel && cancel->load(memory_order_relaxed))
+            {
+                stop_search = true;
+                if (pool)
+                    pool->stop = true;
+            }
+        }
+        return stop_search;
+    }
+
+    // Прерван ли поиск узла: вышло время или узел лежит под отменённой точкой разделения
+    bool aborted(const SplitPoint *split)
+    {
+        return time_is_up() || (split && split->cancelled());
+    }
+
+    // Итог статистики поиска: к счётчикам основного потока добавляются счётчики помощников
+    void finish_stats(const vector<Logic> &helpers, const chrono::steady_clock::time_point start)
+    {
+        for (const auto &helper : helpers)
+            stats.add(helper.stats);
+        stats.time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Выбор политик поиска по настройкам: неизвестная оценка считается NumberOnly, оптимизация - O1
+    void choose_policies(const string &scoring, const string &optimization)
+    {
+        if (scoring == "NumberAndPotential")
+            choose_pruning<NumberAndPotential>(optimization);
+        else
+            choose_pruning<NumberOnly>(optimization);
+    }
+
+    template <class Scoring> void choose_pruning(const string &optimization)
+    {
+        if (optimization == "O0")
+            use_policies<Scoring, O0>();
+        else if (optimization == "O2")
+            use_policies<Scoring, O2>();
+        else
+            use_policies<Scoring, O1>();
+    }
+
+    template <class Scoring, class Pruning> void use_policies()
+    {
+        score_fn = &Logic::calc_score<Scoring>;
+        root_search_fn = &Logic::find_first_best_turn<Scoring, Pruning>;
+        // Без отсечений окно ничего не ускоряет
+        aspiration = Pruning::beta_cut;
+        split_task_fn = &Logic::run_split_task<Scoring, Pruning>;
     }
 
     // Оценка позиции на доске
-    double calc_score(const vector<vector<POS_T>> &mtx, const bool first_bot_color) const
+    // Счётчики фигур и продвижения ведёт make_turn, поэтому оценка не просматривает доску
+    template <class Scoring> double calc_score(const Position &pos, const bool first_bot_color) const
     {
         // Подсчет фигур и оценка позиции
         // color - who is max player
-        double w = 0, wq = 0, b = 0, bq = 0;
-        for (POS_T i = 0; i < 8; ++i)
+        double w = pos.men[0], wq = pos.queens[0];
+        double b = pos.men[1], bq = pos.queens[1];
+        // Дополнительные очки за продвижение вперед
+        if (Scoring::potential)
         {
-            for (POS_T j = 0; j < 8; ++j)
-            {
-                w += (mtx[i][j] == 1);
-                wq += (mtx[i][j] == 3);
-                b += (mtx[i][j] == 2);
-                bq += (mtx[i][j] == 4);
-                // Дополнительные очки за продвижение вперед
-                if (scoring_mode == "NumberAndPotential")
-                {
-                    w += 0.05 * (mtx[i][j] == 1) * (7 - i); // белым выгоднее вверху
-                    b += 0.05 * (mtx[i][j] == 2) * (i); // чёрным выгоднее внизу
-                }
-            }
+            w += 0.05 * pos.advance[0]; // белым выгоднее вверху
+            b += 0.05 * pos.advance[1]; // чёрным выгоднее внизу
         }
         if (!first_bot_color)
         {
@@ -91,57 +507,74 @@ private:
         if (b + bq == 0)
             return 0;
         // Коэффициент ценности дамки
-        int q_coef = 4;
-        if (scoring_mode == "NumberAndPotential")
-        {
-            q_coef = 5;
-        }
+        const int q_coef = Scoring::king_coef;
         // Сила противника / сила бота
         return (b + bq * q_coef) / (w + wq * q_coef);
     }
 
     // Поиск лучшего хода для первого уровня рекурсии
-    double find_first_best_turn(vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y, size_t state,
-                                double alpha = -1)
+    // series_sq - шашка, которая продолжает серию взятий (-1 - начало хода)
+    // alpha, beta - окно оценки корня (при поиске с окном вокруг прошлой оценки)
+    template <class Scoring, class Pruning>
+    double find_first_best_turn(Position &pos, const bool color, const int series_sq, size_t state,
+                                double alpha = -1, const double beta = INF + 1)
     {
+        ++stats.nodes;
         // Добавление новой записи в дерево решений для текущего состояния
-        next_move.emplace_back(-1, -1, -1, -1); // инициализация лучшего хода
+        next_move.emplace_back(); // инициализация лучшего хода
         next_best_state.push_back(-1); // инициализация ссылки на следующее состояние
 
-        // Если это не корень, то поиск ходов для конкретной шашки
-        if (state != 0) {
-            find_turns(x, y, mtx);
+        // В корне поиск всех ходов, иначе поиск ходов для конкретной шашки
+        // Случайный порядок ходов только в корне: при равных оценках бот выбирает случайный ход
+        MoveList now_turns;
+        bool now_have_beats;
+        if (state == 0) {
+            now_have_beats = list_turns(color, pos, now_turns);
+            shuffle(now_turns.begin(), now_turns.end(), rand_eng);
+            // Лучший ход прошлой итерации углубления - первым
+            auto it = find(now_turns.begin(), now_turns.end(), root_turn);
+            if (it != now_turns.end())
+                rotate(now_turns.begin(), it, it + 1);
+        }
+        else {
+            now_have_beats = list_piece_turns(series_sq, pos, now_turns);
         }
-        // Сохранение найденных ходов
-        auto now_turns = turns;
-        // Сохранение флага наличия взятий
-        auto now_have_beats = have_beats;
         // Если серия взятий закончилась — переход хода сопернику и переход к минимакс
         if (!now_have_beats && state != 0) {
-            return find_best_turns_rec(mtx, 1 - color, 0, alpha);
+            return find_best_turns_rec<Scoring, Pruning>(pos, 1 - color, 0, alpha, beta);
         }
         double best_score = -1; // лучшая оценка для текущего состояния
 
         // Перебор всех возможных ходов из текущей позиции
-        for (auto turn : now_turns) {
+        for (int i = 0; i < now_turns.size(); ++i) {
+            const PackedMove turn = now_turns[i];
             size_t new_state = next_move.size(); // индекс для следующего состояния
             double score;
+            MoveUndo undo;
+            make_move(pos, turn, undo);
             // Если есть взятия - продолжение серии (тот же игрок ходит снова)
             if (now_have_beats) {
                 // Рекурсивный вызов для продолжения серии взятий
-                score = find_first_best_turn(make_turn(mtx, turn), color, turn.x2, turn.y2, new_state, best_score);
+                score = find_first_best_turn<Scoring, Pruning>(pos, color, turn.to(), new_state, alpha, beta);
             }
             else {
                 // Обычный ход - переход хода к противнику
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, 0, best_score);
+                score = search_child<Scoring, Pruning>(pos, 1 - color, 0, alpha, beta, i == 0, nullptr);
             }
+            unmake_move(pos, turn, undo);
+            // Время вышло - результат итерации неполный
+            if (stop_search)
+                return best_score;
             // Если найден ход с лучшей оценкой - обновление дерева решений
             if (score > best_score) {
                 best_score = score;
                 next_move[state] = turn;
                 next_best_state[state] = (now_have_beats ? new_state : -1);
             }
-
+            alpha = max(alpha, best_score);
+            // Оценка выше окна: итерация всё равно будет повторена с открытым окном
+            if (Pruning::beta_cut && best_score > beta)
+                break;
         }
 
         // Возврат лучшей найденной оценки
@@ -149,217 +582,715 @@ private:
     }
 
     // Рекурсивный поиск лучшего хода с минимаксом и альфа-бета отсечением
-    double find_best_turns_rec(vector<vector<POS_T>> mtx, const bool color, const size_t depth, double alpha = -1,
-                               double beta = INF + 1, const POS_T x = -1, const POS_T y = -1)
+    // split - ближайшая точка разделения выше по дереву (при поиске в несколько потоков YBW)
+    // Поиск идёт на одной позиции: ходы делаются и отменяются на месте
+    // series_sq - шашка, которая продолжает серию взятий (-1 - начало хода)
+    template <class Scoring, class Pruning>
+    double find_best_turns_rec(Position &pos, const bool color, const size_t depth, double alpha = -1,
+                               double beta = INF + 1, const int series_sq = -1, const SplitPoint *split = nullptr)
     {
+        // Время вышло или узел отменён - оценка не важна, результат будет отброшен
+        if (aborted(split))
+            return 0;
+        ++stats.nodes;
+        // Позиция из баз эндшпиля: результат известен точно, ничья оценивается как равенство сил
+        uint8_t tablebase_value;
+        if (series_sq == -1 && tablebase->probe(pos, color, tablebase_value)) {
+            ++stats.tablebase_hits;
+            if (tablebase_value == TB_DRAW)
+                return 1;
+            // На нечётной глубине ходит бот
+            return ((tablebase_value % 2 == 1) == (depth % 2 == 1) ? INF : 0);
+        }
         // Достигнута максимальная глубина поиска
         if (depth == Max_depth) {
+            // Посреди размена позиция не оценивается: взятия обязательны, поэтому они досчитываются
+            if (quiescence_depth > 0 && has_beats(color, pos))
+                return quiescence<Scoring, Pruning>(pos, color, depth, alpha, beta, -1, quiescence_depth, split);
             // Оценка позиции с учетом чётности глубины
-            return calc_score(mtx, (depth % 2 == color));
+            ++stats.leaves;
+            return calc_score<Scoring>(pos, (depth % 2 == color));
         }
 
+        // Проверка таблицы транспозиций (только в начале хода, не посреди серии взятий)
+        const double alpha_before = alpha, beta_before = beta;
+        uint64_t key = 0;
+        PackedMove tt_turn = PackedMove();
+        if (series_sq == -1) {
+            key = tt_key(pos, color, depth);
+            TTEntry entry;
+            const bool found = tt->probe(key, entry);
+            ++stats.tt_probes;
+            stats.tt_hits += found;
+            const int left = int(Max_depth - depth);
+            if (found && (tt_exact_depth ? entry.depth == left : entry.depth >= left)) {
+                // Окно замкнутое: оценка, равная границе, считается точной, поэтому граница из таблицы
+                // годится только строго за окном
+                if (entry.bound == Bound::EXACT ||
+                    (entry.bound == Bound::LOWER && entry.score > beta) ||
+                    (entry.bound == Bound::UPPER && entry.score < alpha)) {
+                    return entry.score;
+                }
+            }
+            // Лучший ход прошлого поиска этой позиции проверяется первым
+            if (found) {
+                tt_turn = entry.best;
+            }
+        }
+
+        // Ходы узла хранятся на стеке
+        MoveList now_turns;
+        bool now_have_beats;
         // Если продолжается серия взятий, то поиск ходов только для одной шашки
-        if (x != -1) {
-            find_turns(x, y, mtx);
+        if (series_sq != -1) {
+            now_have_beats = list_piece_turns(series_sq, pos, now_turns);
         }
         else {
             // Иначе новый ход
-            find_turns(color, mtx);
+            now_have_beats = list_turns(color, pos, now_turns);
         }
-        // Сохранение найденных ходов
-        auto now_turns = turns;
-        // Сохранение флага наличия взятий
-        auto now_have_beats = have_beats;
 
         // Если закончилась серия взятий, то переход хода
-        if (!now_have_beats && x != -1) {
-            return find_best_turns_rec(mtx, 1 - color, depth + 1, alpha, beta);
+        if (!now_have_beats && series_sq != -1) {
+            return find_best_turns_rec<Scoring, Pruning>(pos, 1 - color, depth + 1, alpha, beta, -1, split);
         }
 
         // Если нет доступных ходов - конец игры
-        if (turns.empty()) {
+        if (now_turns.empty()) {
             return (depth % 2 ? 0 : INF);
         }
+        order_turns(now_turns, pos, tt_turn, depth);
         double min_score = INF + 1;
         double max_score = -1;
+        PackedMove best_turn = PackedMove();
+        Cut cut = Cut::NONE;
 
         // Перебор всех возможных ходов
-        for (auto turn : now_turns) {
-            double score;
-            // Если есть взятия, то серия продолжается
-            if (now_have_beats) {
-                score = find_best_turns_rec(make_turn(mtx, turn), color, depth, alpha, beta, turn.x2, turn.y2);
+        for (int i = 0; i < now_turns.size() && cut == Cut::NONE; ++i) {
+            // YBW: первый ход просчитан, остальные раздаются потокам
+            if (i == 1 && pool && int(Max_depth - depth) >= MIN_SPLIT_DEPTH) {
+                SplitPoint sp;
+                sp.pos = pos;
+                sp.color = color;
+                sp.depth = depth;
+                sp.max_depth = Max_depth;
+                sp.have_beats = now_have_beats;
+                sp.turns = &now_turns;
+                sp.alpha = alpha;
+                sp.beta = beta;
+                sp.min_score = min_score;
+                sp.max_score = max_score;
+                sp.best_turn = best_turn;
+                sp.parent = split;
+                split_search<Scoring, Pruning>(sp);
+                alpha = sp.alpha;
+                beta = sp.beta;
+                min_score = sp.min_score;
+                max_score = sp.max_score;
+                best_turn = sp.best_turn;
+                cut = (sp.equal_cut ? Cut::EQUAL : Cut::NONE);
+                stats.add_cutoffs(depth, sp.cutoff);
+                break;
             }
-            else {
-                // Обычный ход: смена игрока, увеличение глубины
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, depth + 1, alpha, beta);
+            const double score =
+                search_turn<Scoring, Pruning>(pos, now_turns[i], color, depth, now_have_beats, alpha, beta, i == 0,
+                                              split);
+            // Неполный результат не сохраняется в таблицу
+            if (aborted(split))
+                return 0;
+            cut = add_score<Pruning>(score, now_turns[i], depth, alpha, beta, min_score, max_score, best_turn);
+            if (cut != Cut::NONE) {
+                stats.add_cutoffs(depth, 1);
+                stats.first_cutoffs += (i == 0);
             }
+        }
+        if (aborted(split))
+            return 0;
+        if (cut == Cut::EQUAL) {
+            return (depth % 2 ? max_score + 1 : min_score - 1);
+        }
 
-            min_score = min(min_score, score);
-            max_score = max(max_score, score);
+        // макс возвращает максимум, мин — минимум
+        const double res = (depth % 2 ? max_score : min_score);
+        // Сохранение результата: вне окна [alpha, beta] оценка является лишь границей
+        if (series_sq == -1) {
+            Bound bound = Bound::EXACT;
+            if (res < alpha_before)
+                bound = Bound::UPPER;
+            else if (res > beta_before)
+                bound = Bound::LOWER;
+            tt->store(key, Max_depth - depth, bound, res, best_turn);
+        }
+        return res;
+    }
 
-            // Альфа-бета отсечение
-            if (depth % 2) {
-                alpha = max(alpha, max_score);
-            }
-            else {
-                beta = min(beta, min_score);
+    // Досчёт взятий за горизонтом поиска: перебираются только серии взятий, пока у ходящего они есть,
+    // но не больше left ходов. Позиция без взятий оценивается сразу (выбора "не бить" в шашках нет,
+    // поэтому оценка тихой позиции и есть её значение)
+    template <class Scoring, class Pruning>
+    double quiescence(Position &pos, const bool color, const size_t depth, double alpha, double beta,
+                      const int series_sq, const int left, const SplitPoint *split)
+    {
+        ++stats.quiescence_nodes;
+        MoveList now_turns;
+        if (series_sq != -1) {
+            // Серия взятий закончилась - ход переходит сопернику
+            if (!list_piece_turns(series_sq, pos, now_turns))
+                return quiescence<Scoring, Pruning>(pos, 1 - color, depth + 1, alpha, beta, -1, left - 1, split);
+        }
+        else if (left == 0 || !list_turns(color, pos, now_turns)) {
+            ++stats.leaves;
+            return calc_score<Scoring>(pos, (depth % 2 == color));
+        }
+        double min_score = INF + 1;
+        double max_score = -1;
+        PackedMove best_turn = PackedMove();
+        Cut cut = Cut::NONE;
+        for (int i = 0; i < now_turns.size() && cut == Cut::NONE; ++i) {
+            MoveUndo undo;
+            make_move(pos, now_turns[i], undo);
+            const double score =
+                quiescence<Scoring, Pruning>(pos, color, depth, alpha, beta, now_turns[i].to(), left, split);
+            unmake_move(pos, now_turns[i], undo);
+            if (aborted(split))
+                return 0;
+            // Здесь только взятия, поэтому ходы-убийцы и история не обновляются
+            cut = add_score<Pruning>(score, now_turns[i], depth, alpha, beta, min_score, max_score, best_turn);
+        }
+        if (cut == Cut::EQUAL) {
+            return (depth % 2 ? max_score + 1 : min_score - 1);
+        }
+        return (depth % 2 ? max_score : min_score);
+    }
+
+    // Сброс эвристик упорядочивания перед новым поиском
+    void new_ordering()
+    {
+        killers.assign(2 * (MAX_SEARCH_DEPTH + 1), PackedMove());
+        // История прошлых ходов полезна, но должна постепенно забываться
+        for (auto &from : history)
+        {
+            for (auto &cnt : from)
+                cnt /= 2;
+        }
+    }
+
+    // Упорядочивание ходов для альфа-бета отсечения: сначала ход из таблицы транспозиций,
+    // затем взятия и превращения по выигрышу материала, затем ходы-убийцы этой глубины,
+    // остальные - по истории отсечений
+    void order_turns(MoveList &now_turns, const Position &pos, const PackedMove tt_turn, const size_t depth) const
+    {
+        long long priority[MAX_TURNS];
+        for (int i = 0; i < now_turns.size(); ++i)
+        {
+            priority[i] = calc_priority(now_turns[i], pos, tt_turn, depth);
+        }
+        // Сортировка вставками: ходов мало, порядок равных сохраняется
+        for (int i = 1; i < now_turns.size(); ++i)
+        {
+            for (int j = i; j > 0 && priority[j] > priority[j - 1]; --j)
+            {
+                swap(priority[j], priority[j - 1]);
+                swap(now_turns[j], now_turns[j - 1]);
             }
+        }
+    }
 
-            // Применение оптимизаций
-            if (optimization != "00" && alpha > beta) {
-                break;
+    // Приоритет хода при упорядочивании
+    long long calc_priority(const PackedMove turn, const Position &pos, const PackedMove tt_turn,
+                            const size_t depth) const
+    {
+        const long long TT_PRIORITY = 1LL << 42, BEAT_PRIORITY = 1LL << 41, KILLER_PRIORITY = 1LL << 40;
+        if (turn == tt_turn)
+            return TT_PRIORITY;
+        const int sq = turn.from(), sq2 = turn.to();
+        const BB_T from = BB_T(1) << sq;
+        // Выигрыш материала: битая дамка дороже шашки, превращение в дамку тоже выгодно
+        int gain = 0;
+        if (turn.is_beat())
+            gain += (pos.kings & (BB_T(1) << turn.beaten())) ? 4 : 1;
+        if (!(pos.kings & from) && ((BB_T(1) << sq2) & ((pos.white & from) ? ROW_0 : ROW_7)))
+            gain += 3;
+        if (gain)
+            return BEAT_PRIORITY + gain;
+        if (turn == killers[2 * depth])
+            return KILLER_PRIORITY + 1;
+        if (turn == killers[2 * depth + 1])
+            return KILLER_PRIORITY;
+        return history[sq][sq2];
+    }
+
+    // Ход вызвал отсечение: тихий ход запоминается как убийца и повышается в истории
+    void update_cutoff(const PackedMove turn, const size_t depth)
+    {
+        if (turn.is_beat())
+            return;
+        if (turn != killers[2 * depth])
+        {
+            killers[2 * depth + 1] = killers[2 * depth];
+            killers[2 * depth] = turn;
+        }
+        const int left = int(Max_depth - depth) + 1;
+        history[turn.from()][turn.to()] += left * left;
+    }
+
+    // Просчёт одного хода из узла: ход делается на месте и отменяется после поиска
+    // first - первый ход узла, он всегда ищется с полным окном
+    template <class Scoring, class Pruning>
+    double search_turn(Position &pos, const PackedMove turn, const bool color, const size_t depth,
+                       const bool now_have_beats, const double alpha, const double beta, const bool first,
+                       const SplitPoint *split)
+    {
+        MoveUndo undo;
+        make_move(pos, turn, undo);
+        double score;
+        // Если есть взятия, то серия продолжается
+        if (now_have_beats) {
+            score = search_child<Scoring, Pruning>(pos, color, depth, alpha, beta, first, split, turn.to());
+        }
+        else {
+            // Обычный ход: смена игрока, увеличение глубины
+            score = search_child<Scoring, Pruning>(pos, 1 - color, depth + 1, alpha, beta, first, split);
+        }
+        unmake_move(pos, turn, undo);
+        return score;
+    }
+
+    // Поиск с главным вариантом (PVS): первый ход узла считается лучшим и ищется с полным окном,
+    // остальные только проверяются пустым окном на границе (alpha у бота, beta у соперника).
+    // Окно здесь замкнутое, отсечение только при alpha > beta, поэтому пустое окно - alpha == beta:
+    // оценка на границе точная, за границей - лишь граница. Если ход оказался внутри окна,
+    // он лучше первого, и его оценка уточняется полным поиском
+    template <class Scoring, class Pruning>
+    double search_child(Position &pos, const bool color, const size_t depth, const double alpha, const double beta,
+                        const bool first, const SplitPoint *split, const int series_sq = -1)
+    {
+        // Ход узла выбирает тот, кто ходил, а не тот, кто ходит в дочерней позиции
+        const bool bot_turn = (series_sq == -1 ? depth % 2 == 0 : depth % 2 == 1);
+        if (!Pruning::zero_window || first || alpha >= beta)
+            return find_best_turns_rec<Scoring, Pruning>(pos, color, depth, alpha, beta, series_sq, split);
+        const double bound = (bot_turn ? alpha : beta);
+        const double score = find_best_turns_rec<Scoring, Pruning>(pos, color, depth, bound, bound, series_sq, split);
+        if (score <= alpha || score >= beta || aborted(split))
+            return score;
+        ++stats.researches;
+        return find_best_turns_rec<Scoring, Pruning>(pos, color, depth, alpha, beta, series_sq, split);
+    }
+
+    // Учёт оценки хода: обновление лучших оценок и окна, проверка отсечения
+    template <class Pruning>
+    Cut add_score(const double score, const PackedMove turn, const size_t depth, double &alpha, double &beta,
+                  double &min_score, double &max_score, PackedMove &best_turn)
+    {
+        // Запоминание лучшего хода для таблицы транспозиций
+        if (depth % 2 ? score > max_score : score < min_score) {
+            best_turn = turn;
+        }
+        min_score = min(min_score, score);
+        max_score = max(max_score, score);
+
+        // Альфа-бета отсечение
+        if (depth % 2) {
+            alpha = max(alpha, max_score);
+        }
+        else {
+            beta = min(beta, min_score);
+        }
+
+        // Применение оптимизаций
+        if (Pruning::beta_cut && alpha > beta) {
+            update_cutoff(turn, depth);
+            return Cut::BETA;
+        }
+        if (Pruning::equal_cut && alpha == beta) {
+            update_cutoff(turn, depth);
+            return Cut::EQUAL;
+        }
+        return Cut::NONE;
+    }
+
+    // Точка разделения YBW: ходы со второго раздаются как задачи, а поток, пока ждёт их,
+    // сам берёт задачи из поддерева этого узла
+    template <class Scoring, class Pruning> void split_search(SplitPoint &sp)
+    {
+        sp.pending = int(sp.turns->size()) - 1;
+        for (int i = sp.turns->size() - 1; i > 0; --i)
+            pool->push(worker_id, SplitTask{&sp, size_t(i)});
+        SplitTask task;
+        while (sp.pending > 0)
+        {
+            if (pool->pop(worker_id, task, &sp) || pool->steal(worker_id, task, &sp))
+                run_split_task<Scoring, Pruning>(task);
+            else
+                this_thread::yield();
+        }
+    }
+
+    // Выполнение задачи YBW: ход просчитывается с текущим окном точки разделения,
+    // при отсечении оставшиеся задачи точки отменяются
+    template <class Scoring, class Pruning> void run_split_task(const SplitTask &task)
+    {
+        SplitPoint &sp = *task.sp;
+        if (!sp.cancelled())
+        {
+            const int level = Max_depth;
+            Max_depth = sp.max_depth;
+            double alpha, beta;
+            {
+                lock_guard<mutex> guard(sp.lock);
+                alpha = sp.alpha;
+                beta = sp.beta;
             }
-            if (optimization == "02" && alpha == beta) {
-                return (depth % 2 ? max_score + 1 : min_score - 1);
+            // Задачи одной точки идут в разных потоках, поэтому каждая работает со своей копией позиции
+            Position pos = sp.pos;
+            const PackedMove turn = (*sp.turns)[int(task.index)];
+            const double score =
+                search_turn<Scoring, Pruning>(pos, turn, sp.color, sp.depth, sp.have_beats, alpha, beta, false, &sp);
+            if (!aborted(&sp))
+            {
+                lock_guard<mutex> guard(sp.lock);
+                // Задачи заканчиваются в разном порядке, а лучшим должен остаться ход,
+                // который раньше в списке, как при поиске в один поток
+                const bool better = (sp.depth % 2 ? score > sp.max_score : score < sp.min_score);
+                const bool same = (sp.depth % 2 ? score == sp.max_score : score == sp.min_score);
+                const PackedMove best_before = sp.best_turn;
+                const Cut cut = add_score<Pruning>(score, turn, sp.depth, sp.alpha, sp.beta, sp.min_score, sp.max_score,
+                                          sp.best_turn);
+                if (!better && same && turn_index(sp, turn) < turn_index(sp, best_before))
+                    sp.best_turn = turn;
+                if (cut == Cut::EQUAL)
+                    sp.equal_cut = true;
+                if (cut != Cut::NONE)
+                    sp.cutoff = true;
             }
+            Max_depth = level;
         }
+        --sp.pending;
+    }
 
-        // макс возвращает максимум, мин — минимум
-        return (depth % 2 ? max_score : min_score);
+    // Номер хода в списке точки разделения
+    static size_t turn_index(const SplitPoint &sp, const PackedMove turn)
+    {
+        return size_t(find(sp.turns->begin(), sp.turns->end(), turn) - sp.turns->begin());
+    }
+
+    // Поток YBW: берёт задачи из своей очереди и ворует у других, пока поиск не закончен
+    void split_worker()
+    {
+        SplitTask task;
+        while (!pool->quit)
+        {
+            if (pool->pop(worker_id, task) || pool->steal(worker_id, task))
+                (this->*split_task_fn)(task);
+            else
+                this_thread::yield();
+        }
+    }
+
+    // Ключ узла в таблице транспозиций.
+    // Оценки считаются с точки зрения бота, а одна таблица служит ботам обоих цветов,
+    // поэтому кроме очереди хода в ключ входит цвет бота (на нечётной глубине ходит бот)
+    uint64_t tt_key(const Position &pos, const bool color, const size_t depth) const
+    {
+        const bool bot_color = (depth % 2 ? color : !color);
+        return pos.key ^ (color ? ZOBRIST.black_turn : 0) ^ (bot_color ? ZOBRIST.black_bot : 0);
     }
 
 public:
     // Поиск ходов для игрока указанного цвета
-    void find_turns(const bool color)
+    void find_turns(const bool color, const vector<vector<POS_T>> &mtx)
     {
-        find_turns(color, board->get_board());
+        find_turns(color, Position(mtx));
     }
 
     // Поиск ходов для конкретной шашки
-    void find_turns(const POS_T x, const POS_T y)
+    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>> &mtx)
     {
-        find_turns(x, y, board->get_board());
+        find_turns(x, y, Position(mtx));
     }
 
-private:
-    // Поиск всех ходов для всех шашек игрока
-    void find_turns(const bool color, const vector<vector<POS_T>> &mtx)
+    // Поиск всех ходов для всех шашек игрока (результат в turns и have_beats)
+    void find_turns(const bool color, const Position &pos)
+    {
+        MoveList now_turns;
+        have_beats = list_turns(color, pos, now_turns);
+        set_turns(now_turns);
+    }
+
+    // Поиск ходов для одной шашки
+    void find_turns(const POS_T x, const POS_T y, const Position &pos)
+    {
+        MoveList now_turns;
+        have_beats = list_piece_turns(square_of(x, y), pos, now_turns);
+        set_turns(now_turns);
+    }
+
+    // Есть ли у игрока взятие (без составления списка ходов)
+    bool has_beats(const bool color, const Position &pos) const
     {
-        vector<move_pos> res_turns;
-        bool have_beats_before = false;
-        // Проверка каждой клетки
-        for (POS_T i = 0; i < 8; ++i)
+        const BB_T own = pos.pieces(color), opp = pos.pieces(!color), empty = pos.empty();
+        for (int dir = 0; dir < 4; ++dir)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            const int back = reverse_dir(dir);
+            if (own & ~pos.kings & step(step(empty, back) & opp, back))
+                return true;
+        }
+        // Дамка бьёт первую фигуру соперника на диагонали, если за ней есть свободная клетка
+        for (BB_T rest = own & pos.kings; rest; rest &= rest - 1)
+        {
+            const BB_T bit = BB_T(1) << low_bit(rest);
+            for (int dir = 0; dir < 4; ++dir)
             {
-                if (mtx[i][j] && mtx[i][j] % 2 != color)
-                {
-                    find_turns(i, j, mtx);
-                    // Обязательность взятия: если найдено взятие - удаление обычных ходов
-                    if (have_beats && !have_beats_before)
-                    {
-                        have_beats_before = true;
-                        res_turns.clear();
-                    }
-                    if ((have_beats_before && have_beats) || !have_beats_before)
-                    {
-                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
-                    }
-                }
+                BB_T over = step(bit, dir);
+                while (over & empty)
+                    over = step(over, dir);
+                if ((over & opp) && (step(over, dir) & empty))
+                    return true;
             }
         }
-        turns = res_turns;
-        shuffle(turns.begin(), turns.end(), rand_eng);
-        have_beats = have_beats_before;
+        return false;
     }
 
-    // Поиск ходов для одной шашки
-    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>> &mtx)
+    // Все ходы игрока в список, возвращает true, если это взятия
+    bool list_turns(const bool color, const Position &pos, MoveList &res) const
+    {
+        res.clear();
+        const BB_T own = pos.pieces(color), opp = pos.pieces(!color), empty = pos.empty();
+        // Шашки, которые могут бить: пустая клетка за шашкой соперника, сдвинутая назад на две клетки
+        // Дамки бьют издалека, поэтому проверяются все
+        BB_T beaters = own & pos.kings;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            const int back = reverse_dir(dir);
+            beaters |= own & ~pos.kings & step(step(empty, back) & opp, back);
+        }
+        // Обязательность взятия: если есть взятие - обычные ходы не рассматриваются
+        for (BB_T rest = beaters; rest; rest &= rest - 1)
+        {
+            add_beats(low_bit(rest), pos, res);
+        }
+        if (!res.empty())
+            return true;
+        for (BB_T rest = own; rest; rest &= rest - 1)
+        {
+            add_moves(low_bit(rest), pos, res);
+        }
+        return false;
+    }
+
+    // Ходы фигуры с клетки sq в список, возвращает true, если это взятия
+    bool list_piece_turns(const int sq, const Position &pos, MoveList &res) const
+    {
+        res.clear();
+        // Если есть взятия - только они разрешены
+        add_beats(sq, pos, res);
+        if (!res.empty())
+            return true;
+        add_moves(sq, pos, res);
+        return false;
+    }
+
+    // Симуляция хода на копии позиции
+    Position make_turn(Position pos, const move_pos &turn) const
+    {
+        MoveUndo undo;
+        make_move(pos, PackedMove(turn), undo);
+        return pos;
+    }
+
+    // Ход на месте: в undo запоминается битая фигура и превращение, чтобы unmake_move вернул позицию
+    void make_move(Position &pos, const PackedMove turn, MoveUndo &undo) const
+    {
+        const int sq = turn.from(), sq2 = turn.to();
+        const BB_T from = BB_T(1) << sq, to = BB_T(1) << sq2;
+        // Ключ Зобриста и счётчики оценки обновляются вместе с позицией
+        const POS_T type = pos.at(sq);
+        // Ход с пустой клетки (make_turn принимает любой move_pos) не выполняется
+        undo = MoveUndo();
+        if (!type)
+            return;
+        pos.key ^= ZOBRIST.piece[type - 1][sq];
+        pos.count_piece(type, sq, -1);
+        // Удаление битой шашки
+        if (turn.is_beat())
+        {
+            const int sq_b = turn.beaten();
+            undo.beaten = pos.at(sq_b);
+            pos.key ^= ZOBRIST.piece[undo.beaten - 1][sq_b];
+            pos.count_piece(undo.beaten, sq_b, -1);
+            const BB_T beaten = ~(BB_T(1) << sq_b);
+            pos.white &= beaten;
+            pos.black &= beaten;
+            pos.kings &= beaten;
+        }
+        // Перемещение шашки
+        const bool is_white = type % 2;
+        BB_T &own = is_white ? pos.white : pos.black;
+        own ^= from | to;
+        // Превращение в дамку при достижении края
+        undo.promoted = (type <= 2 && (to & (is_white ? ROW_0 : ROW_7)));
+        if (type > 2)
+            pos.kings ^= from | to;
+        else if (undo.promoted)
+            pos.kings |= to;
+        const POS_T new_type = POS_T(type + (undo.promoted ? 2 : 0));
+        pos.key ^= ZOBRIST.piece[new_type - 1][sq2];
+        pos.count_piece(new_type, sq2, 1);
+    }
+
+    // Отмена хода, сделанного make_move
+    void unmake_move(Position &pos, const PackedMove turn, const MoveUndo &undo) const
+    {
+        const int sq = turn.from(), sq2 = turn.to();
+        const BB_T from = BB_T(1) << sq, to = BB_T(1) << sq2;
+        const POS_T new_type = pos.at(sq2), type = POS_T(new_type - (undo.promoted ? 2 : 0));
+        pos.key ^= ZOBRIST.piece[new_type - 1][sq2];
+        pos.count_piece(new_type, sq2, -1);
+        // Шашка возвращается назад, превращение отменяется
+        BB_T &own = (type % 2) ? pos.white : pos.black;
+        own ^= from | to;
+        if (new_type > 2)
+            pos.kings &= ~to;
+        if (type > 2)
+            pos.kings |= from;
+        pos.key ^= ZOBRIST.piece[type - 1][sq];
+        pos.count_piece(type, sq, 1);
+        // Битая фигура возвращается на доску
+        if (undo.beaten)
+        {
+            const int sq_b = turn.beaten();
+            const BB_T bit = BB_T(1) << sq_b;
+            (undo.beaten % 2 ? pos.white : pos.black) |= bit;
+            if (undo.beaten > 2)
+                pos.kings |= bit;
+            pos.key ^= ZOBRIST.piece[undo.beaten - 1][sq_b];
+            pos.count_piece(undo.beaten, sq_b, 1);
+        }
+    }
+
+    // Все ходы целиком: серия взятий считается одним ходом
+    // Возвращает последовательности шагов и позиции после них
+    vector<pair<vector<move_pos>, Position>> find_full_turns(const Position &pos, const bool color) const
+    {
+        vector<pair<vector<move_pos>, Position>> res;
+        vector<move_pos> series;
+        MoveList now_turns;
+        const bool now_have_beats = list_turns(color, pos, now_turns);
+        add_full_turns(pos, now_turns, now_have_beats, series, res);
+        return res;
+    }
+
+    // Подсчёт позиций на глубине depth (perft), ход - вся серия взятий
+    uint64_t perft(const Position &pos, const bool color, const int depth) const
+    {
+        Position now = pos;
+        return perft_rec(now, color, depth, -1);
+    }
+
+private:
+    // Подсчёт perft на одной позиции, ходы делаются и отменяются на месте
+    // series_sq - шашка, которая продолжает серию взятий
+    uint64_t perft_rec(Position &pos, const bool color, const int depth, const int series_sq) const
+    {
+        if (series_sq == -1 && depth == 0)
+            return 1;
+        MoveList now_turns;
+        const bool now_have_beats = (series_sq != -1 ? list_piece_turns(series_sq, pos, now_turns)
+                                                     : list_turns(color, pos, now_turns));
+        // Серия взятий закончилась - ход переходит сопернику
+        if (series_sq != -1 && !now_have_beats)
+            return perft_rec(pos, !color, depth - 1, -1);
+        uint64_t res = 0;
+        for (const PackedMove turn : now_turns)
+        {
+            MoveUndo undo;
+            make_move(pos, turn, undo);
+            if (now_have_beats)
+                res += perft_rec(pos, color, depth, turn.to());
+            else
+                res += perft_rec(pos, !color, depth - 1, -1);
+            unmake_move(pos, turn, undo);
+        }
+        return res;
+    }
+
+    // Развёртывание серий взятий в полные ходы
+    void add_full_turns(const Position &pos, const MoveList &now_turns, const bool now_have_beats,
+                        vector<move_pos> &series, vector<pair<vector<move_pos>, Position>> &res) const
+    {
+        for (const PackedMove turn : now_turns)
+        {
+            series.push_back(turn.to_move_pos());
+            Position next = pos;
+            MoveUndo undo;
+            make_move(next, turn, undo);
+            MoveList next_turns;
+            if (now_have_beats && list_piece_turns(turn.to(), next, next_turns))
+                add_full_turns(next, next_turns, true, series, res);
+            else
+                res.emplace_back(series, next);
+            series.pop_back();
+        }
+    }
+
+    // Перевод найденных ходов в координаты доски для интерфейса
+    void set_turns(const MoveList &now_turns)
     {
         turns.clear();
-        have_beats = false;
-        POS_T type = mtx[x][y];
-        // Проверка взятий
-        // check beats
-        switch (type)
-        {
-        case 1: // белая шашка
-        case 2: // чёрная шашка
-            // Проверка 4 диагональных направлений на 2 клетки
-            // check pieces
-            for (POS_T i = x - 2; i <= x + 2; i += 4)
+        for (const PackedMove turn : now_turns)
+        {
+            turns.push_back(turn.to_move_pos());
+        }
+    }
+
+    // Добавление взятий фигурой с клетки sq
+    static void add_beats(const int sq, const Position &pos, MoveList &res)
+    {
+        const BB_T bit = BB_T(1) << sq;
+        const BB_T opp = pos.pieces(!(pos.black & bit)), empty = pos.empty();
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            BB_T over = step(bit, dir);
+            // Дамка ходит по диагонали на любое расстояние до первой фигуры
+            if (pos.kings & bit)
             {
-                for (POS_T j = y - 2; j <= y + 2; j += 4)
-                {
-                    if (i < 0 || i > 7 || j < 0 || j > 7)
-                        continue;
-                    POS_T xb = (x + i) / 2, yb = (y + j) / 2;
-                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
-                        continue;
-                    turns.emplace_back(x, y, i, j, xb, yb);
-                }
+                while (over & empty)
+                    over = step(over, dir);
             }
-            break;
-        default:
-            // Дамка ходит по диагонали на любое расстояние
-            // check queens
-            for (POS_T i = -1; i <= 1; i += 2)
+            if (!(over & opp))
+                continue;
+            const int sq_b = low_bit(over);
+            // Шашка встаёт сразу за битой фигурой, дамка - на любую свободную клетку за ней
+            for (BB_T land = step(over, dir); land & empty; land = step(land, dir))
             {
-                for (POS_T j = -1; j <= 1; j += 2)
-                {
-                    POS_T xb = -1, yb = -1;
-                    // Движение по диагонали
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2])
-                        {
-                            if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1))
-                            {
-                                break;
-                            }
-                            xb = i2;
-                            yb = j2;
-                        }
-                        if (xb != -1 && xb != i2)
-                        {
-                            turns.emplace_back(x, y, i2, j2, xb, yb);
-                        }
-                    }
-                }
+                res.push_back(PackedMove(sq, low_bit(land), sq_b));
+                if (!(pos.kings & bit))
+                    break;
             }
-            break;
         }
-        // Если есть взятия - только они разрешены
-        // check other turns
-        if (!turns.empty())
+    }
+
+    // Добавление обычных ходов (без взятия) фигурой с клетки sq
+    static void add_moves(const int sq, const Position &pos, MoveList &res)
+    {
+        const BB_T bit = BB_T(1) << sq;
+        const BB_T empty = pos.empty();
+        // Шашка ходит только вперёд: белые вверх, чёрные вниз
+        int dir_begin = (pos.white & bit) ? 0 : 2, dir_end = dir_begin + 2;
+        // Дамка ходит во все стороны
+        if (pos.kings & bit)
         {
-            have_beats = true;
-            return;
+            dir_begin = 0;
+            dir_end = 4;
         }
-        // Проверка обычных ходов (без взятия)
-        switch (type)
+        for (int dir = dir_begin; dir < dir_end; ++dir)
         {
-        case 1: // белая шашка
-        case 2: // чёрная шашка
-            // check pieces
+            for (BB_T to = step(bit, dir); to & empty; to = step(to, dir))
             {
-                POS_T i = ((type % 2) ? x - 1 : x + 1);
-                for (POS_T j = y - 1; j <= y + 1; j += 2)
-                {
-                    if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j])
-                        continue;
-                    turns.emplace_back(x, y, i, j);
-                }
-                break;
-            }
-        default:
-            // Дамки
-            // check queens
-            for (POS_T i = -1; i <= 1; i += 2)
-            {
-                for (POS_T j = -1; j <= 1; j += 2)
-                {
-                    // Движение по диагонали пока не упремся в шашку или край
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2])
-                            break;
-                        turns.emplace_back(x, y, i2, j2);
-                    }
-                }
+                res.push_back(PackedMove(sq, low_bit(to)));
+                if (!(pos.kings & bit))
+                    break;
             }
-            break;
         }
     }
 
@@ -370,10 +1301,32 @@ private:
 
   private:
     default_random_engine rand_eng;      // Генератор случайных чисел
-    string scoring_mode;                 // Тип оценки
-    string optimization;                 // Уровень оптимизации
-    vector<move_pos> next_move;          // Дерево решений
+    // Поиск, скомпилированный под выбранные в настройках оценку (BotScoringType) и отсечения (Optimization)
+    double (Logic::*score_fn)(const Position &, bool) const;
+    double (Logic::*root_search_fn)(Position &, bool, int, size_t, double, double);
+    void (Logic::*split_task_fn)(const SplitTask &);
+    vector<PackedMove> next_move;        // Дерево решений
     vector<int> next_best_state;         // Следующее состояние после хода
-    Board *board;                        // Ссылка на доску
+    shared_ptr<TransTable> tt;           // Таблица транспозиций, общая для всех потоков
+    shared_ptr<Tablebase> tablebase;     // Базы эндшпиля, общие для всех потоков
+    shared_ptr<OpeningBook> book;        // Книга дебютов
+    bool no_random;                      // Детерминированный выбор хода
+    vector<PackedMove> killers;          // Ходы-убийцы, по два на каждую глубину
+    long long history[32][32] = {};      // История отсечений: откуда и куда
+    PackedMove root_turn = PackedMove(); // Лучший ход прошлой итерации
+    double root_score = 0;               // Оценка последнего поиска
+    bool aspiration = false;             // Начинать итерации углубления с окна вокруг прошлой оценки
+    chrono::steady_clock::time_point deadline; // Время окончания поиска
+    bool check_time = false;             // Ограничен ли поиск по времени
+    bool stop_search = false;            // Время вышло, поиск прерывается
+    unsigned time_counter = 0;           // Счётчик узлов между проверками часов
+    int quiescence_depth;                // Сколько ходов со взятиями досчитывается за горизонтом
+    SearchStats stats;                   // Счётчики текущего поиска этого потока
+    const atomic<bool> *shared_stop = nullptr; // Флаг остановки для потоков-помощников
+    const atomic<bool> *cancel = nullptr; // Флаг отмены поиска извне (опрашивается раз в 1024 узла)
+    shared_ptr<Ponder> ponder;           // Обдумывание на времени соперника
+    bool tt_exact_depth = false;         // Брать из таблицы только записи той же глубины
+    WorkStealing *pool = nullptr;        // Планировщик задач YBW
+    int worker_id = 0;                   // Номер потока в планировщике YBW
     Config *config;                      // Ссылка на конфигурацию
 };
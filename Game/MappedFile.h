@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Файл, отображённый в память только для чтения (базы эндшпиля, книга дебютов).
+// Страницы подгружаются системой по мере обращения и общие для всех процессов
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // Отображение файла, false если файла нет или он пустой
+    bool open(const std::string &path)
+    {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void *view = map ? MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view)
+        {
+            close();
+            return false;
+        }
+        bytes = static_cast<const uint8_t *>(view);
+        length = size_t(file_size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *view = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+        bytes = static_cast<const uint8_t *>(view);
+        length = size_t(st.st_size);
+#endif
+        return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (bytes)
+            UnmapViewOfFile(bytes);
+        if (map)
+            CloseHandle(map);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        map = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes)
+            munmap(const_cast<uint8_t *>(bytes), length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const uint8_t *data() const
+    {
+        return bytes;
+    }
+
+    size_t size() const
+    {
+        return length;
+    }
+
+  private:
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE, map = nullptr;
+#endif
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../Models/Move.h"
+
+// Обдумывание на времени соперника: пока человек выбирает ход, поток бота заранее ищет
+// ответы на его возможные ходы. Готовые ответы хранятся по ключу позиции с очередью хода
+struct Ponder
+{
+    std::atomic<bool> stop{false};                                // человек сходил, поиск прерывается
+    std::mutex lock;                                              // защищает results
+    std::unordered_map<uint64_t, std::vector<move_pos>> results; // найденные ответы бота
+    std::thread worker;
+
+    ~Ponder()
+    {
+        stop = true;
+        if (worker.joinable())
+            worker.join();
+    }
+};
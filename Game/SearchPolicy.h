@@ -0,0 +1,40 @@
+#pragma once
+
+// Политики поиска бота. Сочетание выбирается один раз при загрузке настроек, и для каждого
+// сочетания компилируется свой вариант оценки и перебора: в узлах настройки не проверяются
+
+// Оценка позиции (BotScoringType)
+struct NumberOnly
+{
+    static constexpr bool potential = false; // продвижение шашек не учитывается
+    static constexpr int king_coef = 4;      // ценность дамки в шашках
+};
+
+struct NumberAndPotential
+{
+    static constexpr bool potential = true; // шашка ценнее, чем дальше она продвинулась
+    static constexpr int king_coef = 5;
+};
+
+// Отсечения при переборе (Optimization)
+struct O0
+{
+    static constexpr bool beta_cut = false;    // альфа-бета отсечение
+    static constexpr bool equal_cut = false;   // отсечение на равенстве оценок (может изменить выбор хода)
+    static constexpr bool zero_window = false; // PVS: ходы после первого проверяются пустым окном
+};
+
+struct O1
+{
+    static constexpr bool beta_cut = true;
+    static constexpr bool equal_cut = false;
+    static constexpr bool zero_window = true;
+};
+
+struct O2
+{
+    static constexpr bool beta_cut = true;
+    static constexpr bool equal_cut = true;
+    // В пустом окне alpha == beta, и отсечение на равенстве срабатывало бы после первого же хода
+    static constexpr bool zero_window = false;
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+
+const int MAX_SEARCH_DEPTH = 64; // предел глубины при поиске с ограничением по времени
+
+// Счётчики одного поиска бота. Каждый поток ведёт свои, в конце поиска они складываются.
+// Нужны, чтобы отличать ускорение поиска от уменьшения глубины: узлы, листья, отсечения по глубинам,
+// попадания в таблицу транспозиций
+struct SearchStats
+{
+    std::string source = "search";              // откуда ход: search, tablebase, book, ponder
+    int depth = 0;                              // глубина последней завершённой итерации (Max_depth)
+    double score = 0;                           // оценка корня для ходящего: INF - выигрыш, 0 - проигрыш
+    double time_ms = 0;                         // время поиска
+    uint64_t nodes = 0;                         // узлы дерева, включая шаги серий взятий
+    uint64_t leaves = 0;                        // оценки позиций на максимальной глубине и за ней
+    uint64_t quiescence_nodes = 0;              // узлы досчёта взятий за горизонтом
+    uint64_t tt_probes = 0;                     // обращения к таблице транспозиций
+    uint64_t tt_hits = 0;                       // найденные в таблице записи
+    uint64_t tablebase_hits = 0;                // узлы, оценённые по базам эндшпиля
+    uint64_t first_cutoffs = 0;                 // отсечения на первом же ходе узла
+    uint64_t researches = 0;                    // повторные поиски хода, не уложившегося в пустое окно (PVS)
+    uint64_t aspiration_fails = 0;              // повторы итерации углубления, оценка которой вышла за окно
+    uint64_t cutoffs[MAX_SEARCH_DEPTH + 1] = {}; // отсечения на каждой глубине
+
+    // Добавление счётчиков потока-помощника
+    void add(const SearchStats &other)
+    {
+        nodes += other.nodes;
+        leaves += other.leaves;
+        quiescence_nodes += other.quiescence_nodes;
+        tt_probes += other.tt_probes;
+        tt_hits += other.tt_hits;
+        tablebase_hits += other.tablebase_hits;
+        first_cutoffs += other.first_cutoffs;
+        researches += other.researches;
+        aspiration_fails += other.aspiration_fails;
+        for (int i = 0; i <= MAX_SEARCH_DEPTH; ++i)
+            cutoffs[i] += other.cutoffs[i];
+    }
+
+    // Отсечения на глубине depth. Глубину ограничивает find_best_turns, проверка здесь - на случай
+    // вызова поиска в обход него: за пределом массива отсечения не считаются
+    void add_cutoffs(const size_t depth, const uint64_t count)
+    {
+        if (depth <= MAX_SEARCH_DEPTH)
+            cutoffs[depth] += count;
+    }
+
+    uint64_t total_cutoffs() const
+    {
+        uint64_t res = 0;
+        for (const uint64_t cnt : cutoffs)
+            res += cnt;
+        return res;
+    }
+
+    // Узлов в секунду по всем потокам
+    double nodes_per_second() const
+    {
+        return time_ms > 0 ? nodes * 1000.0 / time_ms : 0;
+    }
+
+    // Эффективный коэффициент ветвления: столько ходов в среднем раскрывается в узле,
+    // чтобы дерево из depth + 1 уровней содержало nodes узлов
+    double branching() const
+    {
+        return nodes > 1 ? std::pow(double(nodes), 1.0 / (depth + 1)) : 0;
+    }
+
+    // Доля отсечений, которые дал первый ход (качество упорядочивания ходов)
+    double first_cutoff_rate() const
+    {
+        const uint64_t total = total_cutoffs();
+        return total ? double(first_cutoffs) / total : 0;
+    }
+
+    double tt_hit_rate() const
+    {
+        return tt_probes ? double(tt_hits) / tt_probes : 0;
+    }
+
+    // Одна строка JSON для лога
+    nlohmann::json to_json() const
+    {
+        nlohmann::json res;
+        res["source"] = source;
+        res["depth"] = depth;
+        res["score"] = score;
+        res["time_ms"] = time_ms;
+        res["nodes"] = nodes;
+        res["leaves"] = leaves;
+        res["quiescence_nodes"] = quiescence_nodes;
+        res["nps"] = std::llround(nodes_per_second());
+        res["branching"] = branching();
+        res["tt_hit_rate"] = tt_hit_rate();
+        res["tablebase_hits"] = tablebase_hits;
+        res["first_cutoff_rate"] = first_cutoff_rate();
+        res["researches"] = researches;
+        res["aspiration_fails"] = aspiration_fails;
+        // Отсечения по глубинам до последней, где они были
+        int last = MAX_SEARCH_DEPTH;
+        while (last >= 0 && !cutoffs[last])
+            --last;
+        res["cutoffs"] = nlohmann::json::array();
+        for (int i = 0; i <= last; ++i)
+            res["cutoffs"].push_back(cutoffs[i]);
+        return res;
+    }
+};
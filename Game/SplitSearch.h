@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "../Models/MoveList.h"
+#include "../Models/Position.h"
+
+// Точка разделения поиска (Young Brothers Wait): первый ход узла уже просчитан в своём потоке,
+// остальные ходы раздаются потокам как отдельные задачи
+struct SplitPoint
+{
+    std::mutex lock;                                // защищает окно и лучшие оценки
+    Position pos;                                   // позиция узла
+    bool color = false;                             // чей ход
+    size_t depth = 0;                               // глубина узла
+    int max_depth = 0;                              // глубина поиска
+    bool have_beats = false;                        // ходы узла - взятия (серия продолжается)
+    const MoveList *turns = nullptr;                // ходы узла (список на стеке потока-владельца, он ждёт задачи)
+    double alpha = 0, beta = 0;                     // текущее окно
+    double min_score = 0, max_score = 0;            // лучшие найденные оценки
+    PackedMove best_turn = PackedMove();            // лучший ход
+    bool equal_cut = false;                         // сработало отсечение на равенстве (O2)
+    std::atomic<bool> cutoff{false};                // отсечение: оставшиеся задачи не нужны
+    std::atomic<int> pending{0};                    // задачи, которые ещё не закончены
+    const SplitPoint *parent = nullptr;             // ближайшая точка разделения выше по дереву
+
+    // Отменён ли узел или кто-то из его предков
+    bool cancelled() const
+    {
+        for (const SplitPoint *sp = this; sp; sp = sp->parent)
+        {
+            if (sp->cutoff.load(std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    // Лежит ли узел в поддереве точки ancestor
+    bool is_under(const SplitPoint *ancestor) const
+    {
+        for (const SplitPoint *sp = this; sp; sp = sp->parent)
+        {
+            if (sp == ancestor)
+                return true;
+        }
+        return false;
+    }
+};
+
+// Задача: просчитать ход с номером index в точке разделения sp
+struct SplitTask
+{
+    SplitPoint *sp = nullptr;
+    size_t index = 0;
+};
+
+// Планировщик с воровством работы: у каждого потока своя очередь задач.
+// Свои задачи берутся с конца (самые свежие и мелкие), чужие воруются с начала (самые крупные).
+// Поток, ждущий свою точку разделения, берёт только задачи из её поддерева,
+// чтобы не застрять в чужой работе
+class WorkStealing
+{
+  public:
+    explicit WorkStealing(const int workers) : queues(workers)
+    {
+    }
+
+    void push(const int worker, const SplitTask &task)
+    {
+        std::lock_guard<std::mutex> guard(queues[worker].lock);
+        queues[worker].tasks.push_back(task);
+    }
+
+    // Задача из своей очереди (если under задан - только из поддерева under)
+    bool pop(const int worker, SplitTask &task, const SplitPoint *under = nullptr)
+    {
+        Queue &queue = queues[worker];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty() || (under && !queue.tasks.back().sp->is_under(under)))
+            return false;
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    // Задача из чужой очереди
+    bool steal(const int thief, SplitTask &task, const SplitPoint *under = nullptr)
+    {
+        for (size_t i = 1; i < queues.size(); ++i)
+        {
+            Queue &queue = queues[(thief + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            for (auto it = queue.tasks.begin(); it != queue.tasks.end(); ++it)
+            {
+                if (under && !it->sp->is_under(under))
+                    continue;
+                task = *it;
+                queue.tasks.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::atomic<bool> stop{false}; // прервать весь поиск (вышло время)
+    std::atomic<bool> quit{false}; // поиск закончен, потоки завершаются
+
+  private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<SplitTask> tasks;
+    };
+    std::vector<Queue> queues;
+};
@@ -0,0 +1,260 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "MappedFile.h"
+
+// Базы эндшпиля: результат с точным числом ходов до конца партии для всех позиций
+// с малым числом фигур. Строятся заранее (Tools/tablebase.cpp) и отображаются в память.
+//
+// Позиция хранится с точки зрения ходящей стороны: если ходят чёрные, доска поворачивается
+// на 180 градусов и цвета меняются местами, поэтому для каждой расстановки хватает одной записи.
+// Один файл - одно соотношение фигур (свои шашки, свои дамки, чужие шашки, чужие дамки),
+// внутри файла номер позиции складывается из номеров множеств клеток каждой группы фигур.
+//
+// Значение записи - число ходов до конца партии при лучшей игре (серия взятий - один ход):
+// чётное - ходящая сторона проигрывает, нечётное - выигрывает, TB_DRAW - ничья
+const uint8_t TB_DRAW = 255;
+const uint8_t TB_MAX_VALUE = 253; // более длинные выигрыши не сохраняются и считаются ничьей
+const int TB_MAX_PIECES = 6;      // больше фигур в файлах баз не бывает
+const char TB_MAGIC[4] = {'C', 'K', 'T', 'B'};
+const size_t TB_HEADER_SIZE = 8;  // сигнатура и соотношение фигур
+
+// Соотношение фигур с точки зрения ходящей стороны
+struct Material
+{
+    int own_men = 0, own_kings = 0, opp_men = 0, opp_kings = 0;
+
+    int pieces() const
+    {
+        return own_men + own_kings + opp_men + opp_kings;
+    }
+
+    // То же соотношение после хода: ходит соперник
+    Material swapped() const
+    {
+        return {opp_men, opp_kings, own_men, own_kings};
+    }
+
+    int code() const
+    {
+        return own_men | own_kings << 4 | opp_men << 8 | opp_kings << 12;
+    }
+
+    bool operator==(const Material &other) const
+    {
+        return code() == other.code();
+    }
+};
+
+class Tablebase
+{
+  public:
+    Tablebase() = default;
+    Tablebase(const Tablebase &) = delete;
+    Tablebase &operator=(const Tablebase &) = delete;
+
+    // Поворот доски на 180 градусов: клетка sq переходит в 31 - sq
+    static BB_T flip(BB_T b)
+    {
+        b = ((b >> 1) & 0x55555555) | ((b & 0x55555555) << 1);
+        b = ((b >> 2) & 0x33333333) | ((b & 0x33333333) << 2);
+        b = ((b >> 4) & 0x0F0F0F0F) | ((b & 0x0F0F0F0F) << 4);
+        b = ((b >> 8) & 0x00FF00FF) | ((b & 0x00FF00FF) << 8);
+        return (b >> 16) | (b << 16);
+    }
+
+    // Позиция с точки зрения ходящей стороны: свои фигуры - белые
+    static Position oriented(const Position &pos, const bool color)
+    {
+        if (!color)
+            return pos;
+        Position res;
+        res.white = flip(pos.black);
+        res.black = flip(pos.white);
+        res.kings = flip(pos.kings);
+        return res;
+    }
+
+    // Соотношение фигур позиции, где ходят белые
+    static Material material(const Position &pos)
+    {
+        return {bit_count(pos.white & ~pos.kings), bit_count(pos.white & pos.kings),
+                bit_count(pos.black & ~pos.kings), bit_count(pos.black & pos.kings)};
+    }
+
+    // Число записей в файле
+    static size_t size(const Material &mat)
+    {
+        return binomial(32, mat.own_men) * binomial(32, mat.own_kings) * binomial(32, mat.opp_men) *
+               binomial(32, mat.opp_kings);
+    }
+
+    // Номер позиции, где ходят белые, в файле её соотношения фигур
+    static size_t index(const Position &pos)
+    {
+        size_t res = rank(pos.white & ~pos.kings);
+        res = res * binomial(32, bit_count(pos.white & pos.kings)) + rank(pos.white & pos.kings);
+        res = res * binomial(32, bit_count(pos.black & ~pos.kings)) + rank(pos.black & ~pos.kings);
+        res = res * binomial(32, bit_count(pos.black & pos.kings)) + rank(pos.black & pos.kings);
+        return res;
+    }
+
+    // Позиция по номеру (ходят белые)
+    // false, если номер не соответствует возможной позиции: фигуры стоят на одной клетке
+    // или шашка стоит на крае, где она уже стала бы дамкой
+    static bool position(const Material &mat, size_t idx, Position &pos)
+    {
+        BB_T groups[4];
+        const int counts[4] = {mat.own_men, mat.own_kings, mat.opp_men, mat.opp_kings};
+        for (int i = 3; i >= 0; --i)
+        {
+            const size_t cnt = binomial(32, counts[i]);
+            groups[i] = unrank(idx % cnt, counts[i]);
+            idx /= cnt;
+        }
+        if ((groups[0] & groups[1]) || ((groups[0] | groups[1]) & (groups[2] | groups[3])) ||
+            (groups[2] & groups[3]) || (groups[0] & ROW_0) || (groups[2] & ROW_7))
+            return false;
+        pos.white = groups[0] | groups[1];
+        pos.black = groups[2] | groups[3];
+        pos.kings = groups[1] | groups[3];
+        pos.key = pos.hash();
+        pos.count_pieces();
+        return true;
+    }
+
+    // Имя файла базы, например "0201.tb" - две дамки против одной
+    static std::string file_name(const Material &mat)
+    {
+        return std::string{char('0' + mat.own_men), char('0' + mat.own_kings), char('0' + mat.opp_men),
+                           char('0' + mat.opp_kings)} +
+               ".tb";
+    }
+
+    // Отображение в память всех файлов баз из каталога dir
+    // Возвращает число загруженных файлов, отсутствующие файлы пропускаются
+    int load(const std::string &dir)
+    {
+        int loaded = 0;
+        for (int om = 0; om <= TB_MAX_PIECES; ++om)
+            for (int ok = 0; om + ok <= TB_MAX_PIECES; ++ok)
+                for (int pm = 0; om + ok + pm <= TB_MAX_PIECES; ++pm)
+                    for (int pk = 0; om + ok + pm + pk <= TB_MAX_PIECES; ++pk)
+                    {
+                        const Material mat{om, ok, pm, pk};
+                        if (om + ok == 0 || pm + pk == 0)
+                            continue;
+                        auto file = std::make_unique<MappedFile>();
+                        if (!file->open(dir + file_name(mat)) || file->size() != TB_HEADER_SIZE + size(mat))
+                            continue;
+                        const uint8_t header[TB_HEADER_SIZE] = {
+                            uint8_t(TB_MAGIC[0]), uint8_t(TB_MAGIC[1]), uint8_t(TB_MAGIC[2]), uint8_t(TB_MAGIC[3]),
+                            uint8_t(om),          uint8_t(ok),          uint8_t(pm),          uint8_t(pk)};
+                        if (!std::equal(header, header + TB_HEADER_SIZE, file->data()))
+                            continue;
+                        add(mat, file->data() + TB_HEADER_SIZE);
+                        files.push_back(std::move(file));
+                        ++loaded;
+                    }
+        return loaded;
+    }
+
+    // Подключение таблицы, лежащей в памяти (используется при построении баз)
+    void add(const Material &mat, const uint8_t *data)
+    {
+        tables[mat.code()] = data;
+        max_pieces = std::max(max_pieces, mat.pieces());
+    }
+
+    // Наибольшее число фигур, для которого есть хотя бы одна база
+    int pieces() const
+    {
+        return max_pieces;
+    }
+
+    // Значение позиции для ходящей стороны color
+    // false, если базы для этого соотношения фигур нет
+    bool probe(const Position &pos, const bool color, uint8_t &value) const
+    {
+        if (bit_count(pos.occupied()) > max_pieces)
+            return false;
+        // Без фигур ходить нечем - поражение
+        if (!pos.pieces(color))
+        {
+            value = 0;
+            return true;
+        }
+        const Position own = oriented(pos, color);
+        const auto it = tables.find(material(own).code());
+        if (it == tables.end())
+            return false;
+        value = it->second[index(own)];
+        return true;
+    }
+
+    // Запись базы в файл
+    static bool save(const std::string &path, const Material &mat, const std::vector<uint8_t> &data)
+    {
+        std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+        const char header[TB_HEADER_SIZE] = {TB_MAGIC[0],       TB_MAGIC[1],        TB_MAGIC[2],      TB_MAGIC[3],
+                                             char(mat.own_men), char(mat.own_kings), char(mat.opp_men),
+                                             char(mat.opp_kings)};
+        fout.write(header, TB_HEADER_SIZE);
+        fout.write(reinterpret_cast<const char *>(data.data()), std::streamsize(data.size()));
+        return bool(fout);
+    }
+
+  private:
+    // Биномиальный коэффициент C(n, k) для n <= 32
+    static size_t binomial(const int n, const int k)
+    {
+        static const std::vector<std::vector<size_t>> table = []() {
+            std::vector<std::vector<size_t>> res(33, std::vector<size_t>(33, 0));
+            for (int i = 0; i <= 32; ++i)
+            {
+                res[i][0] = 1;
+                for (int j = 1; j <= i; ++j)
+                    res[i][j] = res[i - 1][j - 1] + res[i - 1][j];
+            }
+            return res;
+        }();
+        return (k < 0 || k > n) ? 0 : table[n][k];
+    }
+
+    // Номер множества клеток среди всех множеств того же размера:
+    // сумма C(sq_i, i + 1) по клеткам в порядке возрастания
+    static size_t rank(BB_T b)
+    {
+        size_t res = 0;
+        for (int i = 1; b; b &= b - 1, ++i)
+            res += binomial(low_bit(b), i);
+        return res;
+    }
+
+    // Множество из k клеток по его номеру
+    static BB_T unrank(size_t idx, const int k)
+    {
+        BB_T res = 0;
+        int sq = 31;
+        for (int i = k; i > 0; --i)
+        {
+            while (binomial(sq, i) > idx)
+                --sq;
+            res |= BB_T(1) << sq;
+            idx -= binomial(sq, i);
+            --sq;
+        }
+        return res;
+    }
+
+    std::unordered_map<int, const uint8_t *> tables; // данные баз по коду соотношения фигур
+    std::vector<std::unique_ptr<MappedFile>> files;   // открытые файлы
+    int max_pieces = 0;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../Models/MoveList.h"
+
+// Тип оценки, сохранённой в таблице
+enum class Bound : uint8_t
+{
+    EXACT, // точное значение
+    LOWER, // значение не меньше сохранённого (было отсечение)
+    UPPER  // значение не больше сохранённого (ни один ход не улучшил альфу)
+};
+
+// Запись таблицы транспозиций
+struct TTEntry
+{
+    uint64_t key = 0;                          // полный ключ позиции
+    double score = 0;                          // оценка
+    PackedMove best = PackedMove();            // лучший ход
+    int8_t depth = -1;                         // оставшаяся глубина поиска
+    Bound bound = Bound::EXACT;                // тип оценки
+    uint8_t age = 0;                           // номер поиска, в котором сделана запись
+};
+
+// Таблица транспозиций фиксированного размера.
+// Живёт всё время партии, поэтому результаты прошлых ходов бота переиспользуются.
+// Одна таблица общая для всех потоков поиска и работает без блокировок:
+// запись хранится в трёх словах, ключ - в виде key ^ score ^ data, и запись,
+// наполовину перезаписанная другим потоком, просто не совпадёт по ключу
+class TransTable
+{
+  public:
+    // Выделение таблицы размером не больше size_mb мегабайт (число записей - степень двойки)
+    void resize(const size_t size_mb)
+    {
+        size_t count = 1;
+        while (count * 2 * sizeof(Slot) <= size_mb * 1024 * 1024)
+            count *= 2;
+        table = std::vector<Slot>(count);
+        mask = count - 1;
+    }
+
+    void clear()
+    {
+        for (auto &slot : table)
+        {
+            slot.key.store(0, std::memory_order_relaxed);
+            slot.score.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Начало нового поиска: старые записи становятся кандидатами на замену
+    void new_search()
+    {
+        age = (age + 1) & AGE_MASK;
+    }
+
+    // Поиск записи по ключу, false если позиции нет в таблице
+    bool probe(const uint64_t key, TTEntry &entry) const
+    {
+        const Slot &slot = table[key & mask];
+        const uint64_t score = slot.score.load(std::memory_order_relaxed);
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.key.load(std::memory_order_relaxed) ^ score ^ data) != key || !data)
+            return false;
+        entry.key = key;
+        std::memcpy(&entry.score, &score, sizeof(double));
+        unpack(data, entry);
+        return true;
+    }
+
+    // Сохранение результата поиска.
+    // Запись из текущего поиска заменяется только более глубокой
+    void store(const uint64_t key, const int depth, const Bound bound, const double score, const PackedMove best)
+    {
+        Slot &slot = table[key & mask];
+        TTEntry old;
+        unpack(slot.data.load(std::memory_order_relaxed), old);
+        if (old.age == age && old.depth > depth)
+            return;
+        uint64_t score_bits;
+        std::memcpy(&score_bits, &score, sizeof(double));
+        const uint64_t data = pack(depth, bound, best);
+        slot.key.store(key ^ score_bits ^ data, std::memory_order_relaxed);
+        slot.score.store(score_bits, std::memory_order_relaxed);
+        slot.data.store(data, std::memory_order_relaxed);
+    }
+
+  private:
+    // Упаковка хода, глубины, типа оценки и возраста в одно слово:
+    // биты 0-15 - упакованный ход, 16-23 - глубина + 1, 24-25 - тип, 26-31 - возраст
+    uint64_t pack(const int depth, const Bound bound, const PackedMove best) const
+    {
+        uint64_t data = best.data;
+        data |= uint64_t(uint8_t(depth + 1)) << 16;
+        data |= uint64_t(bound) << 24;
+        data |= uint64_t(age) << 26;
+        return data;
+    }
+
+    static void unpack(const uint64_t data, TTEntry &entry)
+    {
+        entry.best.data = uint16_t(data);
+        entry.depth = int8_t(uint8_t(data >> 16) - 1);
+        entry.bound = Bound((data >> 24) & 3);
+        entry.age = uint8_t(data >> 26);
+    }
+
+    // Ячейка таблицы: три слова, которые потоки читают и пишут независимо
+    struct Slot
+    {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> score{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    static const uint8_t AGE_MASK = 63;
+
+    std::vector<Slot> table = std::vector<Slot>(1);
+    size_t mask = 0;
+    uint8_t age = 0;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "MoveList.h"
+#include "Position.h"
+
+// История партии для отмены ходов и перемотки.
+// Хранятся не доски, а шаги: одно перемещение шашки (ход или одно взятие серии), битая фигура
+// и превращение в дамку. Каждые SNAPSHOT_STEPS шагов запоминается упакованная позиция,
+// поэтому любая позиция восстанавливается не больше чем за SNAPSHOT_STEPS шагов
+class GameHistory
+{
+  public:
+    // Шаг истории, 6 байт вместо копии доски
+    struct Step
+    {
+        PackedMove turn;         // откуда, куда и битая фигура
+        MoveUndo undo;           // код битой фигуры и превращение в дамку
+        uint8_t beat_series = 0; // сколько шашек взято в серии этим шагом включительно (0 - ход без взятия)
+    };
+
+    static const size_t SNAPSHOT_STEPS = 16;
+
+    // Новая партия с начальной позиции
+    void reset(const Position &start)
+    {
+        steps.clear();
+        snapshots.assign(1, start);
+    }
+
+    void push(const PackedMove turn, const MoveUndo &undo, const int beat_series)
+    {
+        steps.push_back({turn, undo, uint8_t(beat_series)});
+        if (steps.size() % SNAPSHOT_STEPS == 0)
+            snapshots.push_back(replay(snapshots.size() - 1, steps.size()));
+    }
+
+    // Снятие последнего шага: он возвращается, чтобы отменить его на доске
+    Step pop()
+    {
+        const Step res = steps.back();
+        if (steps.size() % SNAPSHOT_STEPS == 0)
+            snapshots.pop_back();
+        steps.pop_back();
+        return res;
+    }
+
+    // Число позиций в истории, включая начальную
+    size_t size() const
+    {
+        return steps.size() + 1;
+    }
+
+    // Счётчик серии последнего шага (0 у начальной позиции)
+    int last_beat_series() const
+    {
+        return steps.empty() ? 0 : steps.back().beat_series;
+    }
+
+    // Позиция после первых ply шагов: ближайший снимок и не больше SNAPSHOT_STEPS шагов вперёд.
+    // ply от 0 (начальная позиция) до size() - 1 (текущая), большее значение даёт текущую позицию
+    Position seek(size_t ply) const
+    {
+        ply = std::min(ply, steps.size());
+        return replay(ply / SNAPSHOT_STEPS, ply);
+    }
+
+  private:
+    // Позиция после ply шагов, начиная со снимка номер snapshot
+    Position replay(const size_t snapshot, const size_t ply) const
+    {
+        Position pos = snapshots[snapshot];
+        for (size_t i = snapshot * SNAPSHOT_STEPS; i < ply; ++i)
+            apply(pos, steps[i]);
+        pos.key = pos.hash();
+        pos.count_pieces();
+        return pos;
+    }
+
+    // Шаг вперёд на битовых досках (ключ и счётчики пересчитывает replay)
+    static void apply(Position &pos, const Step &step)
+    {
+        const BB_T from = BB_T(1) << step.turn.from(), to = BB_T(1) << step.turn.to();
+        if (step.undo.beaten)
+        {
+            const BB_T beaten = ~(BB_T(1) << step.turn.beaten());
+            pos.white &= beaten;
+            pos.black &= beaten;
+            pos.kings &= beaten;
+        }
+        BB_T &own = (pos.white & from) ? pos.white : pos.black;
+        own ^= from | to;
+        if (pos.kings & from)
+            pos.kings ^= from | to;
+        else if (step.undo.promoted)
+            pos.kings |= to;
+    }
+
+    std::vector<Step> steps;         // все шаги партии
+    std::vector<Position> snapshots; // позиция после каждых SNAPSHOT_STEPS шагов, первая - начальная
+};
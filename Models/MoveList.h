@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+
+#include "Move.h"
+#include "Position.h"
+
+// Упакованный ход для поиска бота: номера клеток вместо координат (см. Position.h)
+// Биты 0-4 - откуда, 5-9 - куда, 10-14 - битая фигура, 15 - ход со взятием.
+// move_pos остаётся только на границе с интерфейсом и инструментами
+struct PackedMove
+{
+    uint16_t data; // 0 - нет хода (в списках ходов память не обнуляется)
+
+    PackedMove() = default;
+
+    PackedMove(const int from, const int to, const int beaten = -1)
+        : data(uint16_t(from | (to << 5) | (beaten != -1 ? (beaten << 10) | (1 << 15) : 0)))
+    {
+    }
+
+    // Перевод из координат доски
+    explicit PackedMove(const move_pos &turn)
+        : PackedMove(square_of(turn.x, turn.y), square_of(turn.x2, turn.y2),
+                     turn.xb != -1 ? square_of(turn.xb, turn.yb) : -1)
+    {
+    }
+
+    int from() const
+    {
+        return data & 31;
+    }
+
+    int to() const
+    {
+        return (data >> 5) & 31;
+    }
+
+    bool is_beat() const
+    {
+        return data >> 15;
+    }
+
+    // Клетка битой фигуры (только для взятий)
+    int beaten() const
+    {
+        return (data >> 10) & 31;
+    }
+
+    bool empty() const
+    {
+        return data == 0;
+    }
+
+    // Перевод в координаты доски
+    move_pos to_move_pos() const
+    {
+        if (is_beat())
+            return move_pos(square_x(from()), square_y(from()), square_x(to()), square_y(to()),
+                            square_x(beaten()), square_y(beaten()));
+        return move_pos(square_x(from()), square_y(from()), square_x(to()), square_y(to()));
+    }
+
+    bool operator==(const PackedMove &other) const
+    {
+        return data == other.data;
+    }
+    bool operator!=(const PackedMove &other) const
+    {
+        return data != other.data;
+    }
+};
+
+// Больше ходов в позиции не бывает: у каждой из 12 фигур не больше 13 клеток на диагоналях
+const int MAX_TURNS = 156;
+
+// Список ходов фиксированной ёмкости: живёт на стеке узла поиска и не выделяет память
+struct MoveList
+{
+    PackedMove turns[MAX_TURNS];
+    int count = 0;
+
+    void push_back(const PackedMove turn)
+    {
+        turns[count++] = turn;
+    }
+
+    void clear()
+    {
+        count = 0;
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    PackedMove &operator[](const int i)
+    {
+        return turns[i];
+    }
+    const PackedMove &operator[](const int i) const
+    {
+        return turns[i];
+    }
+
+    PackedMove *begin()
+    {
+        return turns;
+    }
+    PackedMove *end()
+    {
+        return turns + count;
+    }
+    const PackedMove *begin() const
+    {
+        return turns;
+    }
+    const PackedMove *end() const
+    {
+        return turns + count;
+    }
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Move.h"
+#include "Position.h"
+
+// Текстовые обозначения для консольных инструментов.
+// Клетка: столбец a-h слева направо, строка 1-8 снизу вверх (белые начинают снизу).
+// Ход: "c3-d4", серия взятий целиком: "c3:e5:c7".
+// Позиция: 8 строк доски сверху вниз через '/', в каждой 8 цифр (0 - пусто, 1-4 - коды фигур
+// как в Board::mtx), затем через пробел очередь хода: w или b
+
+// Название клетки
+inline std::string square_name(const POS_T x, const POS_T y)
+{
+    return {char('a' + y), char('8' - x)};
+}
+
+// Разбор названия клетки, false если это не клетка доски
+inline bool parse_square(const std::string &text, POS_T &x, POS_T &y)
+{
+    if (text.size() != 2 || text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8')
+        return false;
+    y = POS_T(text[0] - 'a');
+    x = POS_T('8' - text[1]);
+    return true;
+}
+
+// Запись хода целиком
+inline std::string turns_name(const std::vector<move_pos> &turns)
+{
+    if (turns.empty())
+        return "";
+    const bool is_beat = (turns[0].xb != -1);
+    std::string res = square_name(turns[0].x, turns[0].y);
+    for (const auto &turn : turns)
+    {
+        res += (is_beat ? ':' : '-');
+        res += square_name(turn.x2, turn.y2);
+    }
+    return res;
+}
+
+// Запись позиции
+inline std::string position_string(const Position &pos, const bool color)
+{
+    std::string res;
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        if (i)
+            res += '/';
+        for (POS_T j = 0; j < 8; ++j)
+            res += ((i + j) % 2 ? char('0' + pos.at(square_of(i, j))) : '0');
+    }
+    res += (color ? " b" : " w");
+    return res;
+}
+
+// Разбор позиции, false если запись некорректна
+inline bool parse_position(const std::string &text, Position &pos, bool &color)
+{
+    std::vector<std::vector<POS_T>> mtx(8, std::vector<POS_T>(8, 0));
+    size_t idx = 0;
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        if (i && (idx >= text.size() || text[idx++] != '/'))
+            return false;
+        for (POS_T j = 0; j < 8; ++j, ++idx)
+        {
+            if (idx >= text.size() || text[idx] < '0' || text[idx] > '4')
+                return false;
+            mtx[i][j] = POS_T(text[idx] - '0');
+            // Фигуры стоят только на тёмных клетках
+            if (mtx[i][j] && (i + j) % 2 == 0)
+                return false;
+        }
+    }
+    while (idx < text.size() && text[idx] == ' ')
+        ++idx;
+    if (idx + 1 != text.size() || (text[idx] != 'w' && text[idx] != 'b'))
+        return false;
+    color = (text[idx] == 'b');
+    pos = Position(mtx);
+    return true;
+}
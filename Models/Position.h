@@ -0,0 +1,247 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Move.h"
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+typedef uint32_t BB_T;
+
+// Упакованное представление позиции для поиска бота.
+// Используются только 32 тёмные клетки: клетка (x, y) имеет номер x * 4 + y / 2,
+// бит с этим номером выставлен, если клетка занята.
+// 32 dark squares, bit (x * 4 + y / 2) is set when the square is occupied
+
+// Маски строк и крайних столбцов
+const BB_T EVEN_ROWS = 0x0F0F0F0F; // строки 0, 2, 4, 6 (тёмные клетки в нечётных столбцах)
+const BB_T ODD_ROWS = 0xF0F0F0F0;  // строки 1, 3, 5, 7 (тёмные клетки в чётных столбцах)
+const BB_T ROW_0 = 0x0000000F;     // верхний край, здесь превращаются белые шашки
+const BB_T ROW_7 = 0xF0000000;     // нижний край, здесь превращаются чёрные шашки
+const BB_T COL_0 = 0x11111111;     // самый левый номер клетки в каждой строке
+const BB_T COL_3 = 0x88888888;     // самый правый номер клетки в каждой строке
+
+// Количество установленных битов
+inline int bit_count(const BB_T b)
+{
+#ifdef _MSC_VER
+    return int(__popcnt(b));
+#else
+    return __builtin_popcount(b);
+#endif
+}
+
+// Номер младшего установленного бита (b != 0)
+inline int low_bit(const BB_T b)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, b);
+    return int(idx);
+#else
+    return __builtin_ctz(b);
+#endif
+}
+
+// Перевод координат доски в номер клетки и обратно
+inline int square_of(const POS_T x, const POS_T y)
+{
+    return x * 4 + y / 2;
+}
+inline POS_T square_x(const int sq)
+{
+    return POS_T(sq >> 2);
+}
+inline POS_T square_y(const int sq)
+{
+    return POS_T(2 * (sq & 3) + !((sq >> 2) & 1));
+}
+
+// Маска одной строки доски
+inline BB_T row_mask(const POS_T x)
+{
+    return BB_T(0xF) << (4 * x);
+}
+
+// Сдвиг всех фигур на одну клетку по диагонали
+// dir: 0 - вверх-влево, 1 - вверх-вправо, 2 - вниз-влево, 3 - вниз-вправо
+// Для чётных и нечётных строк сдвиги отличаются на единицу, поэтому каждая половина
+// сдвигается отдельно, а маски отрезают фигуры, которые ушли бы за край доски
+inline BB_T step(const BB_T b, const int dir)
+{
+    switch (dir)
+    {
+    case 0:
+        return ((b & EVEN_ROWS & ~ROW_0) >> 4) | ((b & ODD_ROWS & ~COL_0) >> 5);
+    case 1:
+        return ((b & EVEN_ROWS & ~ROW_0 & ~COL_3) >> 3) | ((b & ODD_ROWS) >> 4);
+    case 2:
+        return ((b & EVEN_ROWS) << 4) | ((b & ODD_ROWS & ~ROW_7 & ~COL_0) << 3);
+    default:
+        return ((b & EVEN_ROWS & ~COL_3) << 5) | ((b & ODD_ROWS & ~ROW_7) << 4);
+    }
+}
+
+// Противоположное направление
+inline int reverse_dir(const int dir)
+{
+    return 3 - dir;
+}
+
+// Случайные ключи Зобриста для хеширования позиций
+// zobrist keys, fixed seed so hashes are the same between runs
+struct Zobrist
+{
+    uint64_t piece[4][32]; // ключ фигуры (код 1-4) на каждой клетке
+    uint64_t black_turn;   // ход чёрных
+    uint64_t black_bot;    // максимизирующий игрок (бот) играет чёрными
+
+    Zobrist()
+    {
+        std::mt19937_64 gen(20240917);
+        for (auto &type : piece)
+        {
+            for (auto &key : type)
+                key = gen();
+        }
+        black_turn = gen();
+        black_bot = gen();
+    }
+};
+const Zobrist ZOBRIST;
+
+struct Position
+{
+    BB_T white = 0;   // белые шашки и дамки
+    BB_T black = 0;   // чёрные шашки и дамки
+    BB_T kings = 0;   // дамки обоих цветов
+    uint64_t key = 0; // ключ Зобриста, обновляется при каждом ходе
+    // Счётчики для оценки листа, обновляются при каждом ходе вместе с ключом (индекс - цвет)
+    uint8_t men[2] = {0, 0};     // шашки
+    uint8_t queens[2] = {0, 0};  // дамки
+    uint8_t advance[2] = {0, 0}; // сумма продвижения шашек: на сколько строк каждая ушла от своего края
+
+    Position() = default;
+
+    // Построение из матрицы доски (1 - белая, 2 - чёрная, 3 - белая дамка, 4 - чёрная дамка)
+    explicit Position(const std::vector<std::vector<POS_T>> &mtx)
+    {
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = (i + 1) % 2; j < 8; j += 2)
+            {
+                if (!mtx[i][j])
+                    continue;
+                const BB_T bit = BB_T(1) << square_of(i, j);
+                if (mtx[i][j] % 2)
+                    white |= bit;
+                else
+                    black |= bit;
+                if (mtx[i][j] > 2)
+                    kings |= bit;
+            }
+        }
+        key = hash();
+        count_pieces();
+    }
+
+    // Учёт фигуры type на клетке sq в счётчиках оценки: sign = 1 - фигура поставлена, -1 - снята
+    void count_piece(const POS_T type, const int sq, const int sign)
+    {
+        const bool color = (type % 2 == 0);
+        if (type > 2)
+            queens[color] += sign;
+        else
+        {
+            men[color] += sign;
+            advance[color] += sign * (color ? square_x(sq) : 7 - square_x(sq)); // белые идут вверх, чёрные вниз
+        }
+    }
+
+    // Полный пересчёт счётчиков оценки (после прямой записи битовых досок)
+    void count_pieces()
+    {
+        men[0] = men[1] = queens[0] = queens[1] = advance[0] = advance[1] = 0;
+        for (BB_T rest = occupied(); rest; rest &= rest - 1)
+        {
+            const int sq = low_bit(rest);
+            count_piece(at(sq), sq, 1);
+        }
+    }
+
+    // Полный пересчёт ключа Зобриста
+    uint64_t hash() const
+    {
+        uint64_t res = 0;
+        for (BB_T rest = occupied(); rest; rest &= rest - 1)
+        {
+            const int sq = low_bit(rest);
+            res ^= ZOBRIST.piece[at(sq) - 1][sq];
+        }
+        return res;
+    }
+
+    // Обратное преобразование в матрицу доски
+    std::vector<std::vector<POS_T>> to_mtx() const
+    {
+        std::vector<std::vector<POS_T>> mtx(8, std::vector<POS_T>(8, 0));
+        for (int sq = 0; sq < 32; ++sq)
+        {
+            mtx[square_x(sq)][square_y(sq)] = at(sq);
+        }
+        return mtx;
+    }
+
+    // Код фигуры на клетке в тех же обозначениях, что и в матрице доски
+    POS_T at(const int sq) const
+    {
+        const BB_T bit = BB_T(1) << sq;
+        if (white & bit)
+            return (kings & bit) ? 3 : 1;
+        if (black & bit)
+            return (kings & bit) ? 4 : 2;
+        return 0;
+    }
+
+    // Фигуры указанного цвета (0 - белые, 1 - чёрные)
+    BB_T pieces(const bool color) const
+    {
+        return color ? black : white;
+    }
+
+    BB_T occupied() const
+    {
+        return white | black;
+    }
+
+    BB_T empty() const
+    {
+        return ~(white | black);
+    }
+
+    bool operator==(const Position &other) const
+    {
+        return white == other.white && black == other.black && kings == other.kings;
+    }
+};
+
+// Что нужно, чтобы отменить ход на месте: битая фигура и превращение в дамку
+struct MoveUndo
+{
+    POS_T beaten = 0;      // код битой фигуры (0 - взятия не было)
+    bool promoted = false; // шашка стала дамкой
+};
+
+// Начальная расстановка (та же, что строит Board::make_start_mtx): чёрные сверху, белые снизу
+inline Position start_position()
+{
+    Position pos;
+    pos.black = 0x00000FFF;
+    pos.white = 0xFFF00000;
+    pos.key = pos.hash();
+    pos.count_pieces();
+    return pos;
+}
@@ -0,0 +1,262 @@
+// Разбор позиций из файла на всех ядрах без окна и SDL: тестовые наборы, позиции из архивов партий.
+// Файл читается построчно по мере работы, результаты выводятся в порядке позиций файла.
+// Позиций в работе и готовых, но ещё не выведенных, не больше 4 на поток, поэтому память
+// не зависит от размера файла.
+//
+// analyze <positions> [options]
+// positions      - файл позиций, одна на строку в записи perft ("02020202/.../10101010 w"), # - комментарий,
+//                  после позиции можно задать свой предел: depth N или movetime T
+//                  (глубина вне 0..MAX_SEARCH_DEPTH - 1 заменяется ближайшей с предупреждением)
+// --depth N      - глубина поиска (по умолчанию 7, от 0 до MAX_SEARCH_DEPTH - 1)
+// --movetime T   - время на позицию в мс вместо глубины (итеративное углубление, как BotThinkMS, не меньше 0)
+// --jobs N       - число потоков (по умолчанию - число ядер), у каждого своя Logic в один поток
+// --format F     - csv (по умолчанию) или jsonl
+// --config file  - настройки бота в формате settings.json (по умолчанию settings.json)
+// --out file     - файл результатов (по умолчанию stdout)
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/Notation.h"
+
+// Целое число без лишних символов
+bool parse_int(const string &text, int &value)
+{
+    const auto res = from_chars(text.data(), text.data() + text.size(), value);
+    return res.ec == errc() && res.ptr == text.data() + text.size();
+}
+
+// Позиция файла с пределом поиска
+struct Task
+{
+    size_t index = 0; // номер позиции по порядку, по нему восстанавливается порядок вывода
+    int line = 0;     // строка файла
+    Position pos;
+    bool color = false;
+    int depth = 0;
+    int movetime = 0; // 0 - поиск на глубину depth
+};
+
+// Общая очередь потоков: чтение позиций и вывод результатов по порядку
+class Batch
+{
+  public:
+    Batch(istream &in, ostream &out, const size_t window, const int depth, const int movetime)
+        : in(in), out(out), window(window), depth(depth), movetime(movetime)
+    {
+    }
+
+    // Следующая позиция файла, false - файл кончился.
+    // Поток ждёт, пока вывод не догонит чтение: в работе не больше window позиций
+    bool take(Task &task)
+    {
+        unique_lock<mutex> guard(lock);
+        cv.wait(guard, [&]() { return next_index < next_out + window; });
+        string text;
+        while (getline(in, text))
+        {
+            ++line;
+            if (text.empty() || text[0] == '#')
+                continue;
+            istringstream words(text);
+            string board, side, limit;
+            words >> board >> side;
+            task.line = line;
+            task.depth = depth;
+            task.movetime = movetime;
+            if (!parse_position(board + " " + side, task.pos, task.color))
+            {
+                cerr << "bad position at line " << line << ": " << text << "\n";
+                continue;
+            }
+            // Значение предела читается словом: ошибка в нём не мешает разобрать остальные пределы строки
+            string value_text;
+            while (words >> limit)
+            {
+                int value = 0;
+                const bool has_value = (words >> value_text) && parse_int(value_text, value);
+                if (limit == "depth" && has_value)
+                {
+                    // Глубина за пределами таблиц поиска заменяется ближайшей допустимой
+                    task.depth = min(max(value, 0), MAX_SEARCH_DEPTH - 1);
+                    task.movetime = 0;
+                    if (task.depth != value)
+                        cerr << "depth " << value << " at line " << line << " is out of range, using " << task.depth
+                             << "\n";
+                }
+                else if (limit == "movetime" && has_value && value >= 0)
+                {
+                    task.movetime = value;
+                }
+                else
+                {
+                    cerr << "bad limit at line " << line << ": " << limit << " " << value_text << "\n";
+                }
+            }
+            task.index = next_index++;
+            return true;
+        }
+        return false;
+    }
+
+    // Результат позиции index: выводится вместе со всеми готовыми результатами после него
+    void put(const size_t index, string text)
+    {
+        lock_guard<mutex> guard(lock);
+        done[index] = move(text);
+        for (auto it = done.begin(); it != done.end() && it->first == next_out; it = done.erase(it))
+        {
+            out << it->second << "\n";
+            ++next_out;
+        }
+        cv.notify_all();
+    }
+
+    size_t count() const
+    {
+        return next_out;
+    }
+
+  private:
+    istream &in;
+    ostream &out;
+    const size_t window;
+    const int depth, movetime; // пределы по умолчанию
+    mutex lock;
+    condition_variable cv;
+    int line = 0;
+    size_t next_index = 0; // номер следующей прочитанной позиции
+    size_t next_out = 0;   // номер следующей выводимой позиции
+    map<size_t, string> done;
+};
+
+// Строка результата: позиция, лучший ход целиком, оценка для ходящего (INF - выигрыш, 0 - проигрыш),
+// достигнутая глубина, узлы, время и откуда ход (search или tablebase)
+string result_line(const Task &task, const vector<move_pos> &turns, const SearchStats &stats, const bool jsonl)
+{
+    if (jsonl)
+    {
+        json res = stats.to_json();
+        res["line"] = task.line;
+        res["position"] = position_string(task.pos, task.color);
+        res["move"] = turns_name(turns);
+        return res.dump();
+    }
+    ostringstream res;
+    res << task.line << "," << position_string(task.pos, task.color) << "," << turns_name(turns) << ","
+        << stats.score << "," << stats.depth << "," << stats.nodes << "," << stats.time_ms << "," << stats.source;
+    return res.str();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "usage: analyze <positions> [--depth N] [--movetime T] [--jobs N] [--format csv|jsonl]"
+                " [--config file] [--out file]\n";
+        return 1;
+    }
+    int depth = 7, movetime = 0, jobs = max(1u, thread::hardware_concurrency());
+    string format = "csv", config_path = project_path + "settings.json", out_path;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        const string name = argv[i], value = argv[i + 1];
+        if (name == "--depth")
+            depth = stoi(value);
+        else if (name == "--movetime")
+            movetime = stoi(value);
+        else if (name == "--jobs")
+            jobs = max(1, stoi(value));
+        else if (name == "--format")
+            format = value;
+        else if (name == "--config")
+            config_path = value;
+        else if (name == "--out")
+            out_path = value;
+        else
+        {
+            cerr << "unknown option " << name << "\n";
+            return 1;
+        }
+    }
+    if (depth < 0 || depth >= MAX_SEARCH_DEPTH)
+    {
+        cerr << "depth must be from 0 to " << MAX_SEARCH_DEPTH - 1 << "\n";
+        return 1;
+    }
+    if (movetime < 0)
+    {
+        cerr << "movetime must not be negative\n";
+        return 1;
+    }
+    if (format != "csv" && format != "jsonl")
+    {
+        cerr << "unknown format " << format << "\n";
+        return 1;
+    }
+    ifstream fin(argv[1]);
+    if (!fin)
+    {
+        cerr << "cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    ofstream fout;
+    if (!out_path.empty())
+        fout.open(out_path);
+    ostream &out = (out_path.empty() ? cout : fout);
+
+    // Без случайного выбора и книги; потоки делят файл, а не позицию.
+    // Таблица транспозиций потока остаётся от прошлых позиций, поэтому из ходов с равной оценкой
+    // при другом числе потоков может быть выбран другой
+    Config config(config_path);
+    config.set("Bot", "NoRandom", true);
+    config.set("Bot", "BookPath", "");
+    config.set("Bot", "BotThreads", 1);
+    const bool jsonl = (format == "jsonl");
+    if (!jsonl)
+        out << "line,position,move,score,depth,nodes,time_ms,source\n";
+
+    Batch batch(fin, out, size_t(jobs) * 4, depth, movetime);
+    auto start = chrono::steady_clock::now();
+    atomic<uint64_t> nodes{0};
+    // У каждого потока свои настройки: время на ход может быть своим у каждой позиции
+    auto worker = [&]() {
+        Config now_config = config;
+        Logic logic(&now_config);
+        Task task;
+        while (batch.take(task))
+        {
+            now_config.set("Bot", "BotThinkMS", task.movetime);
+            logic.Max_depth = task.depth;
+            // Без ходов позиция проиграна, поиск не нужен
+            vector<move_pos> turns;
+            SearchStats stats;
+            logic.find_turns(task.color, task.pos);
+            if (!logic.turns.empty())
+            {
+                turns = logic.find_best_turns(task.pos, task.color);
+                stats = logic.search_stats();
+            }
+            nodes += stats.nodes;
+            batch.put(task.index, result_line(task, turns, stats, jsonl));
+        }
+    };
+    vector<thread> threads;
+    for (int i = 0; i < jobs; ++i)
+        threads.emplace_back(worker);
+    for (auto &th : threads)
+        th.join();
+    out.flush();
+
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << batch.count() << " positions, " << sec << " sec, " << llround(sec > 0 ? nodes / sec : 0)
+         << " nodes/sec\n";
+    return 0;
+}
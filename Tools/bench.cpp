@@ -0,0 +1,199 @@
+// Замер скорости бота без окна и SDL: стоимость оценки листа и время поиска на фиксированную глубину.
+// Книга, базы эндшпиля и потоки-помощники отключены, бот детерминирован, поэтому
+// выбранные ходы можно сравнивать между версиями.
+// Для каждого поиска считается число выделений памяти: оно не должно зависеть от глубины,
+// память выделяется только в корне (списки ходов корня и результат), но не в узлах дерева.
+//
+// bench [depth] [file]   - глубина поиска (Max_depth, по умолчанию 7) и файл позиций
+//                          (по умолчанию Tools/bench_positions.txt)
+// bench --check [depth] [file] - проверка без замеров: поиск на глубину depth выделяет столько же памяти,
+//                          сколько поиск на глубину 1 той же позиции, а значения по умолчанию в Config
+//                          совпадают по составу и типам с settings.json, иначе код возврата 1
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/Notation.h"
+
+// Счётчик выделений памяти
+atomic<size_t> allocations{0};
+
+void *operator new(size_t size)
+{
+    ++allocations;
+    if (void *res = malloc(size ? size : 1))
+        return res;
+    throw bad_alloc();
+}
+
+// Пара new/delete заменена целиком (malloc и free), GCC этого не видит и предупреждает о несовпадении
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+#pragma GCC diagnostic pop
+
+// Позиции из файла: одна на строку, # - комментарий
+vector<pair<Position, bool>> read_positions(const string &path)
+{
+    vector<pair<Position, bool>> res;
+    ifstream fin(path);
+    string line;
+    while (getline(fin, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        Position pos;
+        bool color;
+        if (!parse_position(line, pos, color))
+        {
+            cerr << "bad position: " << line << "\n";
+            exit(1);
+        }
+        res.emplace_back(pos, color);
+    }
+    return res;
+}
+
+// Позиции, которые встречаются в листьях: случайные партии из позиций файла
+vector<Position> leaf_positions(Logic &logic, const vector<pair<Position, bool>> &starts)
+{
+    vector<Position> res;
+    mt19937 rng(1);
+    for (const auto &start : starts)
+    {
+        for (int game = 0; game < 64; ++game)
+        {
+            Position pos = start.first;
+            bool color = start.second;
+            for (int ply = 0; ply < 16; ++ply)
+            {
+                auto full_turns = logic.find_full_turns(pos, color);
+                if (full_turns.empty())
+                    break;
+                pos = full_turns[rng() % full_turns.size()].second;
+                color = !color;
+                res.push_back(pos);
+            }
+        }
+    }
+    return res;
+}
+
+// Память выделяется только при подготовке поиска, её объём не зависит от глубины.
+// После первого поиска (он заодно наращивает буферы Logic) поиск на глубину 1 той же позиции выделяет
+// ровно столько же, сколько поиск на глубину depth, лишние выделения - это выделения в узлах
+int check_allocations(Config &config, const vector<pair<Position, bool>> &positions, const int depth)
+{
+    Logic logic(&config);
+    int passed = 0;
+    for (const auto &position : positions)
+    {
+        size_t counts[3];
+        const int depths[3] = {depth, 1, depth};
+        for (int i = 0; i < 3; ++i)
+        {
+            logic.Max_depth = depths[i];
+            const size_t allocations_before = allocations;
+            logic.find_best_turns(position.first, position.second);
+            counts[i] = allocations - allocations_before;
+        }
+        const bool ok = (counts[2] == counts[1]);
+        passed += ok;
+        cout << (ok ? "ok   " : "FAIL ") << position_string(position.first, position.second) << ": " << counts[2]
+             << " allocations at depth " << depth << ", " << counts[1] << " at depth 1\n";
+    }
+    cout << passed << "/" << positions.size() << " passed\n";
+    return passed == int(positions.size()) ? 0 : 1;
+}
+
+// Значения по умолчанию в Config совпадают по составу и типам с "settings.json"
+int check_settings()
+{
+    vector<string> notes;
+    const auto errors = Config().check_defaults(notes);
+    for (const auto &note : notes)
+        cout << "note " << note << "\n";
+    for (const auto &error : errors)
+        cout << "FAIL " << error << "\n";
+    cout << "settings: " << (errors.empty() ? "ok" : "defaults differ from settings.json") << "\n";
+    return errors.empty() ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    const bool check = (argc > 1 && string(argv[1]) == "--check");
+    const int arg = (check ? 2 : 1);
+    const int depth = (argc > arg ? stoi(argv[arg]) : 7);
+    const auto positions =
+        read_positions(argc > arg + 1 ? argv[arg + 1] : project_path + "Tools/bench_positions.txt");
+    Config config;
+    config.set("Bot", "NoRandom", true);
+    config.set("Bot", "BotThinkMS", 0);
+    config.set("Bot", "BotThreads", 1);
+    config.set("Bot", "BookPath", "");
+    config.set("Bot", "TablebasePath", "-");
+    if (check)
+    {
+        // Поиск с настройками не того типа прерывается исключением, поэтому они проверяются первыми
+        if (check_settings())
+            return 1;
+        config.set("Bot", "BotScoringType", "NumberAndPotential");
+        return check_allocations(config, positions, depth);
+    }
+
+    // Стоимость оценки листа в обоих режимах
+    for (const string mode : {"NumberOnly", "NumberAndPotential"})
+    {
+        config.set("Bot", "BotScoringType", mode);
+        Logic logic(&config);
+        const auto leaves = leaf_positions(logic, positions);
+        const int rounds = 200;
+        double checksum = 0;
+        auto start = chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round)
+        {
+            for (size_t i = 0; i < leaves.size(); ++i)
+                checksum += logic.evaluate(leaves[i], (i + round) % 2);
+        }
+        const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "eval " << mode << ": " << fixed << setprecision(2) << sec * 1e9 / (double(rounds) * leaves.size())
+             << " ns/leaf, checksum " << setprecision(6) << checksum << "\n";
+    }
+
+    // Поиск на фиксированную глубину
+    config.set("Bot", "BotScoringType", "NumberAndPotential");
+    Logic logic(&config);
+    double total = 0;
+    uint64_t total_nodes = 0, total_researches = 0;
+    for (const auto &position : positions)
+    {
+        logic.Max_depth = depth;
+        const size_t allocations_before = allocations;
+        auto start = chrono::steady_clock::now();
+        const auto turns = logic.find_best_turns(position.first, position.second);
+        const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        total += sec;
+        total_nodes += logic.search_stats().nodes;
+        total_researches += logic.search_stats().researches;
+        cout << position_string(position.first, position.second) << ": " << turns_name(turns) << ", "
+             << setprecision(1) << sec * 1000 << " ms, " << logic.search_stats().nodes << " nodes, "
+             << allocations - allocations_before << " allocations\n";
+    }
+    // Число узлов не зависит от загрузки машины: по нему сравниваются изменения перебора
+    cout << "search depth " << depth << ": " << setprecision(1) << total * 1000 << " ms, " << total_nodes
+         << " nodes, " << total_researches << " researches\n";
+    return 0;
+}
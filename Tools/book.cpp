@@ -0,0 +1,145 @@
+// Построение книги дебютов из партий бота с самим собой (формат описан в Game/Book.h).
+// Партии идут параллельно на всех ядрах и начинаются с нескольких случайных ходов,
+// для первых ходов каждой партии запоминается, чем она закончилась для ходившей стороны.
+//
+// book [config.json] [options]
+// config.json    - настройки бота в формате settings.json (по умолчанию settings.json),
+//                  глубина берётся из WhiteBotLevel или BlackBotLevel в зависимости от цвета
+// --games N      - число партий (по умолчанию 1000)
+// --jobs N       - число одновременных партий (по умолчанию - число ядер)
+// --plies N      - сколько первых ходов партии попадает в книгу (по умолчанию 16)
+// --opening N    - число случайных ходов в начале партии (по умолчанию 2)
+// --min-games N  - ход попадает в книгу, если сыгран хотя бы N раз (по умолчанию 2)
+// --out file     - файл книги (по умолчанию book.bin)
+// --seed S       - зерно случайных ходов (по умолчанию 1)
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "../Game/Book.h"
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+
+// Ход партии: ключи позиции до и после хода и кто ходил
+struct PlayedTurn
+{
+    uint64_t key, next_key;
+    bool color;
+};
+
+// Партия с тем же правилом окончания, что и в Game::play
+// Первые plies ходов записываются в played, возвращаются очки белых (2 - победа, 1 - ничья)
+int play_game(Logic &logic, const int levels[2], const int opening, const int plies, const int max_turns,
+              mt19937 &rng, vector<PlayedTurn> &played)
+{
+    Position pos = start_position();
+    for (int turn_num = 0; turn_num < max_turns; ++turn_num)
+    {
+        const bool color = turn_num % 2;
+        auto full_turns = logic.find_full_turns(pos, color);
+        if (full_turns.empty())
+            return color ? 2 : 0;
+        Position next;
+        if (turn_num < opening)
+            next = full_turns[rng() % full_turns.size()].second;
+        else
+        {
+            logic.Max_depth = levels[color];
+            next = pos;
+            for (const auto &turn : logic.find_best_turns(pos, color))
+                next = logic.make_turn(next, turn);
+        }
+        if (turn_num < plies)
+            played.push_back({OpeningBook::key(pos, color), OpeningBook::key(next, !color), color});
+        pos = next;
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    int arg = 1;
+    Config config = (argc > 1 && string(argv[1]).rfind("--", 0) != 0 ? Config(argv[arg++]) : Config());
+    int games = 1000, jobs = max(1u, thread::hardware_concurrency()), plies = 16, opening = 2, min_games = 2,
+        seed = 1;
+    string out = project_path + "book.bin";
+    for (; arg + 1 < argc; arg += 2)
+    {
+        const string name = argv[arg], value = argv[arg + 1];
+        if (name == "--games")
+            games = stoi(value);
+        else if (name == "--jobs")
+            jobs = max(1, stoi(value));
+        else if (name == "--plies")
+            plies = stoi(value);
+        else if (name == "--opening")
+            opening = stoi(value);
+        else if (name == "--min-games")
+            min_games = stoi(value);
+        else if (name == "--out")
+            out = value;
+        else if (name == "--seed")
+            seed = stoi(value);
+        else
+        {
+            cerr << "usage: book [config.json] [--games N] [--jobs N] [--plies N] [--opening N] [--min-games N]"
+                    " [--out file] [--seed S]\n";
+            return 1;
+        }
+    }
+    // Книга строится с нуля: бот не должен играть по старой книге, а равные ходы выбирает случайно
+    config.set("Bot", "BookPath", "");
+    config.set("Bot", "NoRandom", false);
+    const int levels[2] = {config("Bot", "WhiteBotLevel"), config("Bot", "BlackBotLevel")};
+    const int max_turns = config("Game", "MaxNumTurns");
+
+    mutex lock;
+    map<pair<uint64_t, uint64_t>, BookEntry> book;
+    atomic<int> next_game{0};
+    int finished = 0;
+    auto worker = [&]() {
+        Logic logic(&config);
+        while (true)
+        {
+            const int game = next_game++;
+            if (game >= games)
+                break;
+            mt19937 rng(unsigned(seed) * 1000003u + unsigned(game));
+            vector<PlayedTurn> played;
+            const int white_points = play_game(logic, levels, opening, plies, max_turns, rng, played);
+
+            lock_guard<mutex> guard(lock);
+            for (const auto &turn : played)
+            {
+                BookEntry &entry = book[{turn.key, turn.next_key}];
+                entry.key = turn.key;
+                entry.next_key = turn.next_key;
+                entry.games += 1;
+                entry.points += (turn.color ? 2 - white_points : white_points);
+            }
+            if (++finished % 100 == 0)
+                cout << "games " << finished << ", book turns " << book.size() << endl;
+        }
+    };
+    vector<thread> threads;
+    for (int i = 0; i < jobs; ++i)
+        threads.emplace_back(worker);
+    for (auto &th : threads)
+        th.join();
+
+    vector<BookEntry> entries;
+    for (const auto &it : book)
+    {
+        if (int(it.second.games) >= min_games)
+            entries.push_back(it.second);
+    }
+    if (!OpeningBook::save(out, entries))
+    {
+        cerr << "can't write " << out << "\n";
+        return 1;
+    }
+    cout << "saved " << entries.size() << " of " << book.size() << " turns to " << out << "\n";
+    return 0;
+}
@@ -0,0 +1,304 @@
+// Движок без окна и SDL: построчный текстовый протокол через stdin/stdout для своих оболочек и турниров.
+// Настройки берутся из раздела "Bot" файла settings.json, Logic создаётся только при первом поиске
+// (или по isready), поэтому процесс запускается за миллисекунды.
+//
+// Команды:
+// position startpos [moves m1 m2 ...]       - начальная позиция и ходы из неё
+// position <позиция> [moves m1 m2 ...]      - позиция в записи perft ("02020202/.../10101010 w")
+// setoption name <настройка Bot> value <значение> - изменение настройки (файл не перезаписывается)
+// go depth N | go movetime T | go infinite  - поиск; просто go - глубина уровня бота цвета хода
+//                                             или BotThinkMS, если оно задано
+// stop                                      - остановка поиска, ход последней завершённой глубины
+// isready                                   - ответ readyok, когда движок готов к поиску
+// newgame                                   - новая партия: чистая таблица транспозиций
+// quit                                      - выход (конец ввода - тоже выход)
+//
+// Ответы:
+// info depth D score S nodes N nps X time T pv m - после каждой глубины: оценка для ходящего
+//                                             (win, loss или отношение сил, 1 - равенство),
+//                                             узлы и время с начала поиска, лучший ход
+// info string <текст>                       - ход из книги или баз эндшпиля, ошибки команд
+// bestmove <ход> | bestmove none            - ход целиком, серия взятий как "c3:e5:c7"
+//
+// Глубины перебираются по очереди поиском на фиксированную глубину, поэтому глубина D даёт тот же
+// ход, что и бот уровня D. Поиск идёт в отдельном потоке, команды, кроме stop, quit и isready,
+// ждут его окончания.
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/Notation.h"
+
+class Engine
+{
+  public:
+    Engine() : pos(start_position())
+    {
+        // Время на ход движок отсчитывает сам, Logic ищет на фиксированную глубину
+        think_ms = config("Bot", "BotThinkMS");
+        config.set("Bot", "BotThinkMS", 0);
+    }
+
+    ~Engine()
+    {
+        stop();
+    }
+
+    // Выполнение одной команды, false - выход
+    bool command(const string &line)
+    {
+        istringstream in(line);
+        string name;
+        if (!(in >> name))
+            return true;
+        if (name == "quit")
+            return false;
+        if (name == "stop")
+        {
+            stop();
+            return true;
+        }
+        if (name == "isready")
+        {
+            if (!searcher.joinable())
+                get_logic();
+            say("readyok");
+            return true;
+        }
+        // Остальные команды меняют состояние, которым пользуется поиск
+        wait();
+        if (name == "position")
+            set_position(in);
+        else if (name == "setoption")
+            set_option(in);
+        else if (name == "go")
+            go(in);
+        else if (name == "newgame")
+            logic.reset();
+        else
+            say("info string unknown command " + name);
+        return true;
+    }
+
+  private:
+    void set_position(istringstream &in)
+    {
+        string word;
+        in >> word;
+        Position now_pos;
+        bool now_color = false;
+        if (word == "startpos")
+        {
+            now_pos = start_position();
+        }
+        else
+        {
+            // Запись позиции - два слова: доска и очередь хода
+            string side;
+            in >> side;
+            if (!parse_position(word + " " + side, now_pos, now_color))
+            {
+                say("info string bad position");
+                return;
+            }
+        }
+        if (in >> word && word == "moves")
+        {
+            Logic &now_logic = get_logic();
+            while (in >> word)
+            {
+                bool found = false;
+                for (const auto &full_turn : now_logic.find_full_turns(now_pos, now_color))
+                {
+                    if (turns_name(full_turn.first) == word)
+                    {
+                        now_pos = full_turn.second;
+                        now_color = !now_color;
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found)
+                {
+                    say("info string illegal move " + word);
+                    return;
+                }
+            }
+        }
+        pos = now_pos;
+        color = now_color;
+    }
+
+    void set_option(istringstream &in)
+    {
+        string word, name, value;
+        in >> word >> name >> word;
+        getline(in >> ws, value);
+        if (!config.has("Bot", name))
+        {
+            say("info string unknown option " + name);
+            return;
+        }
+        // Значение в записи JSON, строки можно писать без кавычек
+        json parsed = json::parse(value, nullptr, false);
+        if (parsed.is_discarded())
+            parsed = value;
+        const json now = config("Bot", name);
+        if (parsed.is_number() != now.is_number() || parsed.is_boolean() != now.is_boolean() ||
+            parsed.is_string() != now.is_string())
+        {
+            say("info string bad value for " + name);
+            return;
+        }
+        if (name == "BotThinkMS")
+        {
+            think_ms = parsed;
+            return;
+        }
+        config.set("Bot", name, parsed);
+        // Logic читает настройки при создании
+        logic.reset();
+    }
+
+    void go(istringstream &in)
+    {
+        int depth = config("Bot", string(color ? "Black" : "White") + "BotLevel");
+        int movetime = think_ms;
+        if (movetime > 0)
+            depth = MAX_SEARCH_DEPTH - 1;
+        string word;
+        while (in >> word)
+        {
+            if (word == "depth" && in >> depth)
+                movetime = 0;
+            else if (word == "movetime" && in >> movetime)
+                depth = MAX_SEARCH_DEPTH - 1;
+            else if (word == "infinite")
+                depth = MAX_SEARCH_DEPTH - 1, movetime = 0;
+        }
+        depth = min(max(depth, 0), MAX_SEARCH_DEPTH - 1);
+        get_logic();
+        cancel = false;
+        searcher = thread(&Engine::search, this, depth, movetime);
+    }
+
+    // Углубление до depth или пока не вышло время movetime (0 - без ограничения времени)
+    void search(const int depth, const int movetime)
+    {
+        const auto start = chrono::steady_clock::now();
+        // Время отмеряет отдельный поток: поиск на фиксированную глубину сам часы не смотрит
+        mutex timer_lock;
+        condition_variable timer_cv;
+        bool done = false;
+        thread timer;
+        if (movetime > 0)
+        {
+            timer = thread([&]() {
+                unique_lock<mutex> lock(timer_lock);
+                if (!timer_cv.wait_until(lock, start + chrono::milliseconds(movetime), [&]() { return done; }))
+                    cancel = true;
+            });
+        }
+
+        vector<move_pos> best;
+        uint64_t nodes = 0;
+        for (int now_depth = 0; now_depth <= depth; ++now_depth)
+        {
+            // Нулевая глубина всегда доводится до конца, чтобы у движка был ход
+            logic->set_cancel(now_depth ? &cancel : nullptr);
+            logic->Max_depth = now_depth;
+            auto res = logic->find_best_turns(pos, color);
+            // Результат отменённого поиска не используется
+            if (now_depth && cancel)
+                break;
+            best = res;
+            const SearchStats &stats = logic->search_stats();
+            if (stats.source != "search")
+            {
+                say("info string " + stats.source);
+                break;
+            }
+            nodes += stats.nodes;
+            const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            ostringstream info;
+            info << "info depth " << now_depth << " score ";
+            if (stats.score >= INF)
+                info << "win";
+            else if (stats.score <= 0)
+                info << "loss";
+            else
+                info << fixed << setprecision(4) << stats.score;
+            info << " nodes " << nodes << " nps " << llround(ms > 0 ? nodes * 1000.0 / ms : 0) << " time "
+                 << llround(ms) << " pv " << turns_name(res);
+            say(info.str());
+            // Найден выигрыш или проигрыш - глубже искать незачем
+            if (res.empty() || stats.score >= INF || stats.score <= 0)
+                break;
+        }
+        logic->set_cancel(nullptr);
+        if (timer.joinable())
+        {
+            {
+                lock_guard<mutex> lock(timer_lock);
+                done = true;
+            }
+            timer_cv.notify_one();
+            timer.join();
+        }
+        say("bestmove " + (best.empty() ? string("none") : turns_name(best)));
+    }
+
+    // Отмена поиска: он заканчивается за доли миллисекунды и выдаёт ход
+    void stop()
+    {
+        cancel = true;
+        wait();
+    }
+
+    void wait()
+    {
+        if (searcher.joinable())
+            searcher.join();
+    }
+
+    Logic &get_logic()
+    {
+        if (!logic)
+            logic = make_unique<Logic>(&config);
+        return *logic;
+    }
+
+    // Строки ответа пишут и основной поток, и поиск
+    void say(const string &line)
+    {
+        lock_guard<mutex> lock(out_lock);
+        cout << line << endl;
+    }
+
+    Config config;
+    unique_ptr<Logic> logic;
+    Position pos;
+    bool color = false; // очередь хода: false - белые
+    int think_ms;       // время на ход для go без параметров (BotThinkMS)
+    thread searcher;
+    atomic<bool> cancel{false};
+    mutex out_lock;
+};
+
+int main()
+{
+    ios::sync_with_stdio(false);
+    Engine engine;
+    string line;
+    while (getline(cin, line) && engine.command(line))
+        ;
+    return 0;
+}
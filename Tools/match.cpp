@@ -0,0 +1,224 @@
+// Матч двух ботов без окна и SDL.
+// Партии идут параллельно на всех ядрах, каждый случайный дебют играется дважды со сменой цветов.
+// После каждой партии пересчитываются разница рейтинга Эло и SPRT: матч останавливается,
+// как только одна из гипотез принята.
+//
+// match <first.json> <second.json> [options]
+// first.json, second.json - настройки ботов в формате settings.json (используется раздел "Bot",
+// глубина берётся из WhiteBotLevel или BlackBotLevel в зависимости от цвета)
+// --games N      - максимум партий (по умолчанию 1000)
+// --jobs N       - число одновременных партий (по умолчанию - число ядер)
+// --opening N    - число случайных ходов дебюта (по умолчанию 4)
+// --max-turns N  - ничья после N ходов (по умолчанию MaxNumTurns из settings.json)
+// --elo0 E, --elo1 E, --alpha A, --beta B - параметры SPRT (по умолчанию 0, 10, 0.05, 0.05)
+// --seed S       - зерно дебютов (по умолчанию 1)
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/Notation.h"
+
+// Участник матча
+struct Player
+{
+    Config *config;
+    int level[2]; // глубина за белых и за чёрных
+};
+
+// Случайный дебют: opening ходов из начальной позиции
+// false, если партия закончилась раньше
+bool make_opening(Logic &logic, const int opening, mt19937 &rng, Position &pos, int &turn_num)
+{
+    pos = start_position();
+    for (turn_num = 0; turn_num < opening; ++turn_num)
+    {
+        auto full_turns = logic.find_full_turns(pos, turn_num % 2);
+        if (full_turns.empty())
+            return false;
+        pos = full_turns[rng() % full_turns.size()].second;
+    }
+    return !logic.find_full_turns(pos, turn_num % 2).empty();
+}
+
+// Партия с тем же правилом окончания, что и в Game::play
+// Возвращает очки белых: 1 - победа, 0.5 - ничья, 0 - поражение
+double play_game(Logic *bots[2], const int levels[2], Position pos, int turn_num, const int max_turns)
+{
+    while (turn_num < max_turns)
+    {
+        const bool color = turn_num % 2;
+        bots[color]->find_turns(color, pos);
+        if (bots[color]->turns.empty())
+            return color ? 1 : 0;
+        bots[color]->Max_depth = levels[color];
+        for (const auto &turn : bots[color]->find_best_turns(pos, color))
+            pos = bots[color]->make_turn(pos, turn);
+        ++turn_num;
+    }
+    return 0.5;
+}
+
+// Счёт матча с точки зрения первого бота
+struct Score
+{
+    int wins = 0, draws = 0, losses = 0;
+
+    int games() const
+    {
+        return wins + draws + losses;
+    }
+
+    // Средний результат за партию и его дисперсия
+    // prior - добавка к каждому исходу, чтобы дисперсия не была нулевой, пока все партии с одним результатом
+    double mean(const double prior = 0) const
+    {
+        return (wins + prior + 0.5 * (draws + prior)) / (games() + 3 * prior);
+    }
+    double variance(const double prior = 0) const
+    {
+        const double m = mean(prior);
+        return ((wins + prior) * (1 - m) * (1 - m) + (draws + prior) * (0.5 - m) * (0.5 - m) +
+                (losses + prior) * m * m) /
+               (games() + 3 * prior);
+    }
+};
+
+// Перевод среднего результата в разницу рейтинга и обратно
+double to_elo(const double score)
+{
+    const double s = min(max(score, 1e-6), 1 - 1e-6);
+    return -400 * log10(1 / s - 1);
+}
+double to_score(const double elo)
+{
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+// Логарифм отношения правдоподобия гипотез elo1 и elo0 (нормальное приближение)
+double llr(const Score &score, const double elo0, const double elo1)
+{
+    if (score.games() == 0)
+        return 0;
+    const double var = score.variance(0.5);
+    const double s0 = to_score(elo0), s1 = to_score(elo1);
+    return score.games() * (s1 - s0) * (2 * score.mean(0.5) - s0 - s1) / (2 * var);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        cerr << "usage: match <first.json> <second.json> [--games N] [--jobs N] [--opening N] [--max-turns N]"
+                " [--elo0 E] [--elo1 E] [--alpha A] [--beta B] [--seed S]\n";
+        return 1;
+    }
+    Config settings;
+    Config configs[2] = {Config(argv[1]), Config(argv[2])};
+    int max_games = 1000, jobs = max(1u, thread::hardware_concurrency()), opening = 4, seed = 1;
+    int max_turns = settings("Game", "MaxNumTurns");
+    double elo0 = 0, elo1 = 10, alpha = 0.05, beta = 0.05;
+    for (int i = 3; i + 1 < argc; i += 2)
+    {
+        const string name = argv[i], value = argv[i + 1];
+        if (name == "--games")
+            max_games = stoi(value);
+        else if (name == "--jobs")
+            jobs = max(1, stoi(value));
+        else if (name == "--opening")
+            opening = stoi(value);
+        else if (name == "--max-turns")
+            max_turns = stoi(value);
+        else if (name == "--elo0")
+            elo0 = stod(value);
+        else if (name == "--elo1")
+            elo1 = stod(value);
+        else if (name == "--alpha")
+            alpha = stod(value);
+        else if (name == "--beta")
+            beta = stod(value);
+        else if (name == "--seed")
+            seed = stoi(value);
+        else
+        {
+            cerr << "unknown option " << name << "\n";
+            return 1;
+        }
+    }
+    Player players[2];
+    for (int i = 0; i < 2; ++i)
+        players[i] = {&configs[i], {configs[i]("Bot", "WhiteBotLevel"), configs[i]("Bot", "BlackBotLevel")}};
+    // Границы SPRT: выше upper принимается elo1 (первый бот сильнее), ниже lower - elo0
+    const double lower = log(beta / (1 - alpha)), upper = log((1 - beta) / alpha);
+
+    mutex lock;
+    Score score;
+    atomic<int> next_game{0};
+    atomic<bool> stop{false};
+    string verdict = "no decision";
+    auto start = chrono::steady_clock::now();
+
+    // Партии 2k и 2k + 1 играются из одного дебюта, первый бот играет то белыми, то чёрными
+    auto worker = [&]() {
+        while (!stop)
+        {
+            const int game = next_game++;
+            if (game >= max_games)
+                break;
+            const int first_color = game % 2;
+            Logic first(players[0].config), second(players[1].config);
+            Logic *bots[2] = {first_color ? &second : &first, first_color ? &first : &second};
+            const int levels[2] = {players[first_color].level[0], players[!first_color].level[1]};
+
+            mt19937 rng(unsigned(seed) * 1000003u + unsigned(game / 2));
+            Position pos;
+            int turn_num;
+            while (!make_opening(first, opening, rng, pos, turn_num))
+                ;
+            const double white_result = play_game(bots, levels, pos, turn_num, max_turns);
+            const double result = first_color ? 1 - white_result : white_result;
+
+            lock_guard<mutex> guard(lock);
+            if (stop)
+                break;
+            score.wins += (result == 1);
+            score.draws += (result == 0.5);
+            score.losses += (result == 0);
+            const double ratio = llr(score, elo0, elo1);
+            if (ratio >= upper)
+                verdict = "H1 accepted: elo >= " + to_string(int(elo1));
+            else if (ratio <= lower)
+                verdict = "H0 accepted: elo <= " + to_string(int(elo0));
+            if (ratio >= upper || ratio <= lower)
+                stop = true;
+            if (score.games() % 10 == 0 || stop)
+            {
+                cout << "games " << score.games() << ": +" << score.wins << " =" << score.draws << " -"
+                     << score.losses << ", elo " << fixed << setprecision(1) << to_elo(score.mean()) << ", LLR "
+                     << setprecision(2) << ratio << " [" << lower << ", " << upper << "]" << endl;
+            }
+        }
+    };
+    vector<thread> threads;
+    for (int i = 0; i < jobs; ++i)
+        threads.emplace_back(worker);
+    for (auto &th : threads)
+        th.join();
+
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!score.games())
+        return 1;
+    // Погрешность разницы рейтинга (95%)
+    const double margin = 1.96 * sqrt(score.variance() / score.games());
+    cout << "result: +" << score.wins << " =" << score.draws << " -" << score.losses << " in " << score.games()
+         << " games, " << fixed << setprecision(1) << sec << " sec\n";
+    cout << "elo: " << to_elo(score.mean()) << " [" << to_elo(score.mean() - margin) << ", "
+         << to_elo(score.mean() + margin) << "]\n";
+    cout << "sprt: " << verdict << "\n";
+    return 0;
+}
@@ -0,0 +1,179 @@
+// Подсчёт позиций дерева ходов на заданную глубину (perft) без окна и SDL.
+// Нужен, чтобы проверять и замерять генератор ходов Logic::find_turns.
+// Серия взятий считается одним ходом, как и в поиске бота.
+//
+// perft <depth> [position]    - число позиций для каждого хода из корня, итог и скорость
+// perft --suite <file>        - проверка эталонных чисел из файла (см. Tools/perft_suite.txt)
+// perft --history [games]    - проверка истории партии (Models/GameHistory.h) на случайных партиях:
+//                               перемотка к каждому шагу и откат дают те же позиции, что и сама партия
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Models/GameHistory.h"
+#include "../Models/Notation.h"
+
+// Подсчёт с разбивкой по ходам из корня
+int divide(Logic &logic, const Position &pos, const bool color, const int depth)
+{
+    auto start = chrono::steady_clock::now();
+    uint64_t total = 0;
+    for (const auto &full_turn : logic.find_full_turns(pos, color))
+    {
+        const uint64_t nodes = (depth > 0 ? logic.perft(full_turn.second, !color, depth - 1) : 1);
+        cout << turns_name(full_turn.first) << ": " << nodes << "\n";
+        total += nodes;
+    }
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "total: " << total << "\n";
+    cout << "time: " << int(sec * 1000) << " ms, " << uint64_t(total / max(sec, 1e-9)) << " nodes/sec\n";
+    return 0;
+}
+
+// Проверка эталонных чисел: строки "позиция ; глубина ; число позиций", # - комментарий
+int run_suite(Logic &logic, const string &path)
+{
+    ifstream fin(path);
+    if (!fin)
+    {
+        cerr << "can't open " << path << "\n";
+        return 1;
+    }
+    string line;
+    int failed = 0, checked = 0;
+    uint64_t all_nodes = 0;
+    double all_sec = 0;
+    while (getline(fin, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        const size_t sep1 = line.find(';'), sep2 = line.find(';', sep1 + 1);
+        Position pos;
+        bool color;
+        string text = line.substr(0, sep1);
+        text.erase(text.find_last_not_of(' ') + 1);
+        if (sep2 == string::npos || !parse_position(text, pos, color))
+        {
+            cerr << "bad line: " << line << "\n";
+            return 1;
+        }
+        const int depth = stoi(line.substr(sep1 + 1, sep2 - sep1 - 1));
+        const uint64_t expected = stoull(line.substr(sep2 + 1));
+
+        auto start = chrono::steady_clock::now();
+        const uint64_t nodes = logic.perft(pos, color, depth);
+        const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        all_nodes += nodes;
+        all_sec += sec;
+        ++checked;
+        const bool ok = (nodes == expected);
+        failed += !ok;
+        cout << (ok ? "ok   " : "FAIL ") << text << " depth " << depth << ": " << nodes;
+        if (!ok)
+            cout << " (expected " << expected << ")";
+        cout << ", " << int(sec * 1000) << " ms\n";
+    }
+    cout << checked - failed << "/" << checked << " passed, " << uint64_t(all_nodes / max(all_sec, 1e-9))
+         << " nodes/sec\n";
+    return failed ? 1 : 0;
+}
+
+// Случайные партии по шагам, как их делает Board: каждое взятие серии - отдельный шаг истории.
+// Позиция после каждого шага запоминается и сравнивается с GameHistory::seek, затем история
+// откатывается по шагам до начала с той же проверкой
+int check_history(Logic &logic, const int games)
+{
+    mt19937 rng(1);
+    int failed = 0;
+    uint64_t seeks = 0;
+    double seek_sec = 0;
+    for (int game = 0; game < games; ++game)
+    {
+        GameHistory history;
+        Position pos = start_position();
+        history.reset(pos);
+        vector<Position> played = {pos};
+        bool color = false;
+        for (int turn_num = 0; turn_num < 120; ++turn_num)
+        {
+            logic.find_turns(color, pos);
+            if (logic.turns.empty())
+                break;
+            move_pos turn = logic.turns[rng() % logic.turns.size()];
+            int beat_series = 0;
+            while (true)
+            {
+                beat_series += (turn.xb != -1);
+                MoveUndo undo;
+                logic.make_move(pos, PackedMove(turn), undo);
+                history.push(PackedMove(turn), undo, beat_series);
+                played.push_back(pos);
+                if (turn.xb == -1)
+                    break;
+                logic.find_turns(turn.x2, turn.y2, pos);
+                if (!logic.have_beats)
+                    break;
+                turn = logic.turns[rng() % logic.turns.size()];
+            }
+            color = !color;
+        }
+        // Перемотка к каждому шагу, в том числе за конец истории (это текущая позиция)
+        auto start = chrono::steady_clock::now();
+        bool ok = (history.size() == played.size());
+        for (size_t ply = 0; ply <= played.size(); ++ply)
+            ok = ok && history.seek(ply) == played[min(ply, played.size() - 1)];
+        seek_sec += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        seeks += played.size() + 1;
+        // Откат шагов: после каждого текущая позиция та же, что и до этого шага в партии
+        while (history.size() > 1)
+        {
+            history.pop();
+            ok = ok && history.seek(history.size() - 1) == played[history.size() - 1];
+        }
+        failed += !ok;
+        if (!ok)
+            cout << "FAIL game " << game << ": " << played.size() - 1 << " steps\n";
+    }
+    cout << games - failed << "/" << games << " games passed, seek " << int(seek_sec * 1e9 / max<uint64_t>(seeks, 1))
+         << " ns\n";
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "usage: perft <depth> [position] | perft --suite <file> | perft --history [games]\n";
+        return 1;
+    }
+    Config config;
+    Logic logic(&config);
+    if (string(argv[1]) == "--suite")
+    {
+        return run_suite(logic, argc > 2 ? argv[2] : project_path + "Tools/perft_suite.txt");
+    }
+    if (string(argv[1]) == "--history")
+    {
+        return check_history(logic, argc > 2 ? stoi(argv[2]) : 100);
+    }
+
+    const int depth = stoi(argv[1]);
+    Position pos = start_position();
+    bool color = false;
+    if (argc > 2)
+    {
+        // Позиция может быть передана как одним аргументом, так и двумя (доска и очередь хода)
+        string text = argv[2];
+        for (int i = 3; i < argc; ++i)
+            text += string(" ") + argv[i];
+        if (!parse_position(text, pos, color))
+        {
+            cerr << "bad position: " << text << "\n";
+            return 1;
+        }
+    }
+    return divide(logic, pos, color, depth);
+}
@@ -0,0 +1,217 @@
+// Построение баз эндшпиля ретроградным анализом (формат описан в Game/Tablebase.h).
+// Используются те же правила, что и в игре: дальнобойные дамки, обязательное взятие,
+// превращение посреди серии взятий, серия взятий - один ход.
+//
+// tablebase <max pieces> [dir]   - базы для всех соотношений до max pieces фигур (по умолчанию 4)
+//                                  в каталог dir (по умолчанию Tablebases/), на всех ядрах
+//
+// Позиции решаются проходами: на проходе n получают значение позиции, которые выигрываются
+// или проигрываются ровно за n ходов. Базы с меньшим числом фигур и с меньшим числом шашек
+// (куда ведут взятия и превращения) строятся раньше, соотношение и его зеркальное
+// (после хода ходит соперник) - вместе
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "../Game/Config.h"
+#include "../Game/Logic.h"
+#include "../Game/Tablebase.h"
+
+const uint8_t TB_UNKNOWN = 254; // значение ещё не найдено (только во время построения)
+
+// Одна строящаяся база
+struct Table
+{
+    Material mat;
+    vector<uint8_t> data;
+    vector<uint32_t> pending; // позиции без значения
+};
+
+// Значение позиции по значениям ходов, известным до прохода n
+// TB_UNKNOWN, если на этом проходе значение ещё не определено
+uint8_t solve_position(Logic &logic, const Tablebase &tb, const Position &pos, const uint8_t n)
+{
+    const auto full_turns = logic.find_full_turns(pos, false);
+    if (full_turns.empty())
+        return 0;
+    int best_win = -1, worst_loss = -1;
+    bool all_lose = true; // все ходы ведут к выигрышу соперника
+    for (const auto &full_turn : full_turns)
+    {
+        uint8_t value;
+        if (!tb.probe(full_turn.second, true, value))
+        {
+            cerr << "no table for " << Tablebase::file_name(Tablebase::material(
+                                           Tablebase::oriented(full_turn.second, true)))
+                 << "\n";
+            exit(1);
+        }
+        const bool known = (value < n);
+        // Соперник проигрывает - выигрыш на ход позже
+        if (known && value % 2 == 0 && (best_win == -1 || value + 1 < best_win))
+            best_win = value + 1;
+        if (known && value % 2 == 1)
+            worst_loss = max(worst_loss, value + 1);
+        else
+            all_lose = false;
+    }
+    if (best_win != -1)
+        return uint8_t(best_win);
+    if (all_lose)
+        return uint8_t(worst_loss);
+    return TB_UNKNOWN;
+}
+
+// Построение зеркальных баз group, все базы с меньшим числом фигур или шашек уже подключены
+// Позиции прохода независимы, поэтому делятся между потоками (у каждого своя логика),
+// а найденные значения записываются после прохода
+void solve_group(vector<Logic> &logics, Tablebase &tb, vector<Table *> group, const uint8_t max_lower)
+{
+    for (Table *table : group)
+    {
+        table->data.assign(Tablebase::size(table->mat), TB_UNKNOWN);
+        for (size_t idx = 0; idx < table->data.size(); ++idx)
+        {
+            Position pos;
+            if (Tablebase::position(table->mat, idx, pos))
+                table->pending.push_back(uint32_t(idx));
+            else
+                table->data[idx] = TB_DRAW;
+        }
+        tb.add(table->mat, table->data.data());
+    }
+    const size_t jobs = logics.size();
+    vector<vector<pair<uint32_t, uint8_t>>> found(jobs);
+    vector<vector<uint32_t>> left(jobs);
+    for (int n = 0; n <= TB_MAX_VALUE; ++n)
+    {
+        bool changed = false;
+        for (Table *table : group)
+        {
+            const size_t chunk = (table->pending.size() + jobs - 1) / jobs;
+            vector<thread> workers;
+            for (size_t t = 0; t < jobs; ++t)
+            {
+                workers.emplace_back([&, t]() {
+                    found[t].clear();
+                    left[t].clear();
+                    const size_t end = min(table->pending.size(), (t + 1) * chunk);
+                    for (size_t i = t * chunk; i < end; ++i)
+                    {
+                        const uint32_t idx = table->pending[i];
+                        Position pos;
+                        Tablebase::position(table->mat, idx, pos);
+                        const uint8_t value = solve_position(logics[t], tb, pos, uint8_t(n));
+                        if (value == TB_UNKNOWN)
+                            left[t].push_back(idx);
+                        else
+                            found[t].emplace_back(idx, value);
+                    }
+                });
+            }
+            for (auto &worker : workers)
+                worker.join();
+            table->pending.clear();
+            for (size_t t = 0; t < jobs; ++t)
+            {
+                for (const auto &res : found[t])
+                    table->data[res.first] = res.second;
+                changed |= !found[t].empty();
+                table->pending.insert(table->pending.end(), left[t].begin(), left[t].end());
+            }
+        }
+        // Ходы в меньшие базы могут дать новые значения вплоть до прохода max_lower + 1
+        if (!changed && n > max_lower)
+            break;
+    }
+    // Нерешённые позиции - ничья
+    for (Table *table : group)
+    {
+        for (const uint32_t idx : table->pending)
+            table->data[idx] = TB_DRAW;
+        table->pending.clear();
+        table->pending.shrink_to_fit();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const int max_pieces = (argc > 1 ? stoi(argv[1]) : 4);
+    const string dir = (argc > 2 ? string(argv[2]) + "/" : project_path + "Tablebases/");
+    if (max_pieces < 2 || max_pieces > TB_MAX_PIECES)
+    {
+        cerr << "usage: tablebase <max pieces 2-" << TB_MAX_PIECES << "> [dir]\n";
+        return 1;
+    }
+    filesystem::create_directories(dir);
+    Config config;
+    vector<Logic> logics(max(1u, thread::hardware_concurrency()), Logic(&config));
+    Tablebase tb;
+
+    // Все соотношения фигур в порядке построения: по числу фигур, затем по числу шашек
+    vector<unique_ptr<Table>> tables;
+    for (int total = 2; total <= max_pieces; ++total)
+        for (int om = 0; om <= total; ++om)
+            for (int ok = 0; om + ok <= total; ++ok)
+                for (int pm = 0; om + ok + pm <= total; ++pm)
+                {
+                    const int pk = total - om - ok - pm;
+                    if (om + ok == 0 || pm + pk == 0)
+                        continue;
+                    tables.push_back(make_unique<Table>());
+                    tables.back()->mat = {om, ok, pm, pk};
+                }
+    stable_sort(tables.begin(), tables.end(), [](const unique_ptr<Table> &a, const unique_ptr<Table> &b) {
+        return make_pair(a->mat.pieces(), a->mat.own_men + a->mat.opp_men) <
+               make_pair(b->mat.pieces(), b->mat.own_men + b->mat.opp_men);
+    });
+
+    uint8_t max_lower = 0; // самый длинный выигрыш в построенных базах
+    for (auto &table : tables)
+    {
+        if (!table->data.empty())
+            continue;
+        auto start = chrono::steady_clock::now();
+        vector<Table *> group = {table.get()};
+        if (!(table->mat.swapped() == table->mat))
+        {
+            for (auto &other : tables)
+            {
+                if (other->mat == table->mat.swapped())
+                    group.push_back(other.get());
+            }
+        }
+        solve_group(logics, tb, group, max_lower);
+        const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        for (Table *solved : group)
+        {
+            size_t wins = 0, losses = 0, draws = 0;
+            uint8_t longest = 0;
+            for (const uint8_t value : solved->data)
+            {
+                if (value == TB_DRAW)
+                    ++draws;
+                else
+                {
+                    (value % 2 ? wins : losses) += 1;
+                    longest = max(longest, value);
+                }
+            }
+            max_lower = max(max_lower, longest);
+            const string name = Tablebase::file_name(solved->mat);
+            if (!Tablebase::save(dir + name, solved->mat, solved->data))
+            {
+                cerr << "can't write " << dir + name << "\n";
+                return 1;
+            }
+            cout << name << ": " << solved->data.size() << " positions, " << wins << " wins, " << losses
+                 << " losses, " << draws << " draws or illegal, longest " << int(longest) << " turns, "
+                 << int(sec * 1000) << " ms" << endl;
+        }
+    }
+    return 0;
+}